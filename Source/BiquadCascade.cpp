@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.cpp
+    Created: 24 Oct 2026 3:26:50pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+#include <complex>
+
+BiquadCascade::Coefficients BiquadCascade::fromAnalog(double b0, double b1, double b2, double a0, double a1, double a2, double g)
+{
+    const auto c = 1.0 / g;
+    const auto c2 = c * c;
+
+    const auto norm = 1.0 / (a2 * c2 + a1 * c + a0);
+
+    Coefficients result;
+    result.b0 = (b2 * c2 + b1 * c + b0) * norm;
+    result.b1 = 2.0 * (b0 - b2 * c2) * norm;
+    result.b2 = (b2 * c2 - b1 * c + b0) * norm;
+    result.a1 = 2.0 * (a0 - a2 * c2) * norm;
+    result.a2 = (a2 * c2 - a1 * c + a0) * norm;
+    return result;
+}
+
+BiquadCascade::Coefficients BiquadCascade::fromAnalogFirstOrder(double b0, double b1, double a0, double a1, double g)
+{
+    const auto c = 1.0 / g;
+    const auto norm = 1.0 / (a1 * c + a0);
+
+    Coefficients result;
+    result.b0 = (b1 * c + b0) * norm;
+    result.b1 = (b0 - b1 * c) * norm;
+    result.a1 = (a0 - a1 * c) * norm;
+    return result;
+}
+
+BiquadCascade::Coefficients BiquadCascade::inverse(const Coefficients& c)
+{
+    const auto norm = 1.0 / c.b0;
+
+    Coefficients result;
+    result.b0 = norm;
+    result.b1 = c.a1 * norm;
+    result.b2 = c.a2 * norm;
+    result.a1 = c.b1 * norm;
+    result.a2 = c.b2 * norm;
+    return result;
+}
+
+void BiquadCascade::prepare(int numChannels)
+{
+    states.resize((size_t)numChannels);
+    reset();
+}
+
+void BiquadCascade::reset()
+{
+    for(auto& channelStates : states)
+        channelStates.fill({});
+}
+
+void BiquadCascade::setNumStages(int newNumStages) noexcept
+{
+    newNumStages = juce::jlimit(0, maxStages, newNumStages);
+
+    for(auto& channelStates : states)
+        for(int i = newNumStages; i < numStages; ++i)
+            channelStates[(size_t)i] = {};
+
+    numStages = newNumStages;
+}
+
+double BiquadCascade::getMagnitudeForFrequency(double frequency, double sampleRate) const noexcept
+{
+    const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto z1 = std::polar(1.0, -w);
+    const auto z2 = z1 * z1;
+
+    auto magnitude = 1.0;
+
+    for(int stage = 0; stage < numStages; ++stage)
+    {
+        const auto& c = stages[(size_t)stage];
+        const auto numerator = c.b0 + c.b1 * z1 + c.b2 * z2;
+        const auto denominator = 1.0 + c.a1 * z1 + c.a2 * z2;
+        magnitude *= std::abs(numerator / denominator);
+    }
+
+    return magnitude;
+}
+
+void BiquadCascade::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    if(numStages == 0)
+        return;
+
+    const auto numChannels = juce::jmin(block.getNumChannels(), states.size());
+    const auto numSamples = block.getNumSamples();
+
+    for(size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        auto& channelStates = states[channel];
+
+        for(size_t i = 0; i < numSamples; ++i)
+        {
+            double x = samples[i];
+
+            for(int stage = 0; stage < numStages; ++stage)
+            {
+                const auto& c = stages[(size_t)stage];
+                auto& s = channelStates[(size_t)stage];
+
+                const auto y = c.b0 * x + s.s1;
+                s.s1 = c.b1 * x - c.a1 * y + s.s2;
+                s.s2 = c.b2 * x - c.a2 * y;
+                x = y;
+            }
+
+            samples[i] = (float)x;
+        }
+    }
+}
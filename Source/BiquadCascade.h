@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    Created: 24 Oct 2026 3:26:50pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+// A run of second order sections kept in one flat array and processed in transposed direct form
+// II, every stage for a sample before moving on to the next sample so the signal stays in a
+// register. The number of stages can change at runtime without reallocating; state is kept in
+// doubles so low cutoffs at high sample rates stay quiet.
+class BiquadCascade
+{
+public:
+    static constexpr int maxStages = 8;
+
+    // normalised so a0 is 1
+    struct Coefficients
+    {
+        double b0 {1}, b1 {0}, b2 {0}, a1 {0}, a2 {0};
+    };
+
+    // Bilinear transform of (b2 s^2 + b1 s + b0) / (a2 s^2 + a1 s + a0), with s normalised to a
+    // cutoff that's been prewarped to g = tan(pi * cutoff / sampleRate).
+    static Coefficients fromAnalog(double b0, double b1, double b2, double a0, double a1, double a2, double g);
+
+    // the same for first order sections, (b1 s + b0) / (a1 s + a0)
+    static Coefficients fromAnalogFirstOrder(double b0, double b1, double a0, double a1, double g);
+
+    // swaps poles and zeros, which is only stable for minimum phase sections
+    static Coefficients inverse(const Coefficients& c);
+
+    void prepare(int numChannels);
+    void reset();
+
+    // stages past the new count are cleared, so bringing them back later starts them from rest
+    void setNumStages(int newNumStages) noexcept;
+    int getNumStages() const noexcept { return numStages; }
+
+    void setStage(int index, const Coefficients& c) noexcept { stages[(size_t)index] = c; }
+
+    // of the stages in use, for drawing response curves
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const noexcept;
+
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+    struct State
+    {
+        double s1 {0}, s2 {0};
+    };
+
+    std::array<Coefficients, maxStages> stages;
+    std::vector<std::array<State, maxStages>> states;
+    int numStages {0};
+};
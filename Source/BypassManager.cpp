@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    BypassManager.cpp
+    Created: 22 Oct 2026 2:37:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "BypassManager.h"
+
+void BypassManager::prepare(double sampleRate, int maximumBlockSize, int numChannels, int maximumLatency)
+{
+    for(auto& s : stages)
+    {
+        s.wet.reset(sampleRate, fadeSeconds);
+        s.wet.setCurrentAndTargetValue(s.bypassed ? 0.f : 1.f);
+        s.dry.setSize(numChannels, maximumBlockSize);
+        
+        s.dryDelay.prepare({ sampleRate, (juce::uint32)maximumBlockSize, (juce::uint32)numChannels });
+        s.dryDelay.setMaximumDelayInSamples(maximumLatency);
+        s.latency = juce::jmin(s.latency, maximumLatency);
+        s.dryDelay.setDelay((float)s.latency);
+    }
+}
+
+void BypassManager::setLatency(Stage stage, int latencyInSamples) noexcept
+{
+    auto& s = stages[(size_t)stage];
+    jassert(latencyInSamples <= s.dryDelay.getMaximumDelayInSamples());
+    
+    if(latencyInSamples != s.latency)
+    {
+        s.latency = latencyInSamples;
+        s.dryDelay.setDelay((float)latencyInSamples);
+    }
+}
+
+void BypassManager::setBypassed(Stage stage, bool shouldBeBypassed, bool immediately) noexcept
+{
+    auto& s = stages[(size_t)stage];
+
+    if(immediately)
+    {
+        s.bypassed = shouldBeBypassed;
+        s.wet.setCurrentAndTargetValue(shouldBeBypassed ? 0.f : 1.f);
+        return;
+    }
+
+    if(shouldBeBypassed != s.bypassed)
+    {
+        s.bypassed = shouldBeBypassed;
+        s.wet.setTargetValue(shouldBeBypassed ? 0.f : 1.f);
+    }
+}
+
+void BypassManager::delay(StageState& s, juce::AudioBuffer<float>& buffer) noexcept
+{
+    auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(0, (size_t)buffer.getNumSamples());
+    s.dryDelay.process(juce::dsp::ProcessContextReplacing<float>(block));
+}
+
+void BypassManager::crossfade(StageState& s, juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+{
+    auto* const* wetChannels = buffer.getArrayOfWritePointers();
+    auto* const* dryChannels = s.dry.getArrayOfReadPointers();
+
+    for(int i = 0; i < buffer.getNumSamples(); ++i)
+    {
+        const auto gain = s.wet.getNextValue();
+
+        for(int channel = 0; channel < numChannels; ++channel)
+            wetChannels[channel][i] = dryChannels[channel][i] + gain * (wetChannels[channel][i] - dryChannels[channel][i]);
+    }
+}
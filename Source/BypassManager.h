@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    BypassManager.h
+    Created: 22 Oct 2026 2:37:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// Crossfades each bypassable stage in and out over a few milliseconds instead of switching it
+// between samples. A stage only runs while it's on or fading; once it has faded out it's reset,
+// so switching it back on starts from clean state (under the fade) rather than whatever it was
+// left holding, and a bypassed stage costs nothing. A stage with latency gets its dry side
+// delayed to match, both under the fade and while it's bypassed, so switching it never moves the
+// signal in time.
+class BypassManager
+{
+public:
+    enum Stage
+    {
+        power,
+        inputGain,
+        drive,
+        lowCut,
+        highCut,
+        outputGain,
+        numStages
+    };
+
+    static constexpr double fadeSeconds = 0.005;
+
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels, int maximumLatency = 0);
+
+    // how many samples the stage delays its signal by, up to the maximumLatency it was prepared with
+    void setLatency(Stage stage, int latencyInSamples) noexcept;
+
+    // immediately skips the fade, e.g. for the state the plugin is prepared in
+    void setBypassed(Stage stage, bool shouldBeBypassed, bool immediately = false) noexcept;
+
+    bool isBypassed(Stage stage) const noexcept { return stages[(size_t)stage].bypassed; }
+
+    // faded out completely, so process() won't run anything
+    bool isFullyBypassed(Stage stage) const noexcept
+    {
+        const auto& s = stages[(size_t)stage];
+        return s.bypassed && !s.wet.isSmoothing();
+    }
+
+    // Runs processFunction on the buffer in place if the stage is on, and blends the result with
+    // the input (delayed by the stage's latency) while it's fading. Once bypassed the buffer just
+    // gets that delay. resetFunction is called once a fade out finishes.
+    template <typename ProcessFunction, typename ResetFunction>
+    void process(Stage stage, juce::AudioBuffer<float>& buffer, ProcessFunction&& processFunction, ResetFunction&& resetFunction)
+    {
+        auto& s = stages[(size_t)stage];
+        const auto fading = s.wet.isSmoothing();
+
+        if(!fading && s.bypassed)
+        {
+            if(s.latency > 0)
+                delay(s, buffer);
+
+            return;
+        }
+
+        if(!fading && s.latency == 0)
+        {
+            processFunction();
+            return;
+        }
+
+        // a latent stage keeps its dry delay fed even while it's fully on, so a fade out that
+        // starts later has the right history to blend with
+        const auto numChannels = juce::jmin(buffer.getNumChannels(), s.dry.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+
+        s.dry.setSize(s.dry.getNumChannels(), numSamples, false, false, true);
+        for(int channel = 0; channel < numChannels; ++channel)
+            s.dry.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+        if(s.latency > 0)
+            delay(s, s.dry);
+
+        processFunction();
+
+        if(!fading)
+            return;
+
+        crossfade(s, buffer, numChannels);
+
+        if(s.bypassed && !s.wet.isSmoothing())
+            resetFunction();
+    }
+
+private:
+    struct StageState
+    {
+        juce::SmoothedValue<float> wet {1.f};
+        juce::AudioBuffer<float> dry;
+        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+        int latency {0};
+        bool bypassed {false};
+    };
+
+    static void crossfade(StageState& s, juce::AudioBuffer<float>& buffer, int numChannels) noexcept;
+    static void delay(StageState& s, juce::AudioBuffer<float>& buffer) noexcept;
+
+    std::array<StageState, numStages> stages;
+};
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    CutFilter.cpp
+    Created: 24 Oct 2026 6:02:17pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "CutFilter.h"
+
+double CutFilter::getDecayTimeSeconds(float frequency, Slope slope)
+{
+    // the poles nearest the j axis have a real part of 2 pi f sin(pi / 2n), and it takes
+    // ln(10^6) time constants to fall 120dB
+    const auto order = getOrder(slope);
+    const auto decayRate = juce::MathConstants<double>::twoPi * juce::jmax(1.0, (double)frequency)
+                         * std::sin(juce::MathConstants<double>::pi / (2.0 * order));
+
+    return std::log(1.0e6) / decayRate;
+}
+
+void CutFilter::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    cascade.prepare((int)spec.numChannels);
+
+    // forces the sections to be designed for the new rate
+    frequency = -1;
+}
+
+void CutFilter::reset()
+{
+    cascade.reset();
+}
+
+void CutFilter::setParameters(float cutoffFrequency, Slope newSlope) noexcept
+{
+    if(cutoffFrequency == frequency && newSlope == slope)
+        return;
+
+    frequency = cutoffFrequency;
+    slope = newSlope;
+
+    // the frequency range goes up to 22kHz, which is past nyquist at 44.1k and below
+    const auto cutoff = juce::jlimit(1.0, 0.49 * sampleRate, (double)frequency);
+    const auto g = std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+
+    const auto order = getOrder(slope);
+
+    if(order == 1)
+    {
+        if(type == highpass)
+            cascade.setStage(0, BiquadCascade::fromAnalogFirstOrder(0, 1, 1, 1, g));
+        else
+            cascade.setStage(0, BiquadCascade::fromAnalogFirstOrder(1, 0, 1, 1, g));
+
+        cascade.setNumStages(1);
+        return;
+    }
+
+    const auto numStages = order / 2;
+
+    // each pair of Butterworth poles is s^2 + 2 sin(theta) s + 1, with theta spread evenly
+    for(int i = 0; i < numStages; ++i)
+    {
+        const auto damping = 2.0 * std::sin(juce::MathConstants<double>::pi * (2 * i + 1) / (2.0 * order));
+
+        if(type == highpass)
+            cascade.setStage(i, BiquadCascade::fromAnalog(0, 0, 1, 1, damping, 1, g));
+        else
+            cascade.setStage(i, BiquadCascade::fromAnalog(1, 0, 0, 1, damping, 1, g));
+    }
+
+    cascade.setNumStages(numStages);
+}
+
+double CutFilter::getMagnitudeForFrequency(double frequencyToCheck) const noexcept
+{
+    return cascade.getMagnitudeForFrequency(frequencyToCheck, sampleRate);
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    CutFilter.h
+    Created: 24 Oct 2026 6:02:17pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+// The low and high cut: a Butterworth highpass or lowpass of 6 to 48 dB/oct, one biquad for
+// every 12 dB (or a single first order section for 6 dB, the slope the plugin has always had),
+// run as a single BiquadCascade over both channels. Changing the slope only changes
+// how many of the sections run, and the sections are only designed again when the frequency,
+// slope or sample rate changes.
+class CutFilter
+{
+public:
+    enum Type
+    {
+        highpass,   // the low cut
+        lowpass     // the high cut
+    };
+
+    enum Slope
+    {
+        slope6,
+        slope12,
+        slope24,
+        slope36,
+        slope48
+    };
+
+    static int getOrder(Slope slope) noexcept { return slope == slope6 ? 1 : 2 * (int)slope; }
+
+    // how long the slowest pole takes to die away by 120dB, for the tail length
+    static double getDecayTimeSeconds(float frequency, Slope slope);
+
+    explicit CutFilter(Type filterType) : type(filterType) {}
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    void setParameters(float cutoffFrequency, Slope newSlope) noexcept;
+
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept { cascade.process(block); }
+
+    // for drawing the response curve, doesn't touch the filter's state
+    double getMagnitudeForFrequency(double frequency) const noexcept;
+
+private:
+    BiquadCascade cascade;
+    Type type;
+
+    double sampleRate {44100.0};
+    float frequency {-1};
+    Slope slope {slope6};
+};
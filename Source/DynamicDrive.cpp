@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    DynamicDrive.cpp
+    Created: 24 Oct 2026 10:48:03am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "DynamicDrive.h"
+
+void DynamicDrive::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    delay.prepare(spec);
+    delay.setMaximumDelayInSamples(juce::jmax(1, (int)std::ceil(maxLookaheadSeconds * sampleRate)));
+
+    offsets.assign((size_t)((int)spec.maximumBlockSize / chunkSize + 1), 0.f);
+    reset();
+}
+
+void DynamicDrive::reset()
+{
+    delay.reset();
+    envelope = 0;
+    numChunks = 0;
+    std::fill(offsets.begin(), offsets.end(), 0.f);
+}
+
+int DynamicDrive::calculateLookaheadSamples(const Settings& settings) const noexcept
+{
+    return juce::jlimit(0, (int)std::ceil(maxLookaheadSeconds * sampleRate), juce::roundToInt(settings.lookaheadMs * 0.001 * sampleRate));
+}
+
+void DynamicDrive::process(juce::AudioBuffer<float>& buffer, const Settings& settings) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = buffer.getNumChannels();
+
+    numChunks = juce::jmin((int)offsets.size(), (numSamples + chunkSize - 1) / chunkSize);
+
+    if(settings.amount != 0.f)
+    {
+        const auto amount = settings.amount * 0.01f;
+
+        for(int chunk = 0; chunk < numChunks; ++chunk)
+        {
+            const auto start = chunk * chunkSize;
+            const auto length = juce::jmin(chunkSize, numSamples - start);
+
+            // linked peak of the chunk across the channels
+            auto peak = 0.f;
+            for(int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, start), length);
+                peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+            }
+
+            const auto timeMs = peak > envelope ? settings.attackMs : settings.releaseMs;
+            const auto coefficient = std::exp(-(float)length / (juce::jmax(0.01f, timeMs) * 0.001f * (float)sampleRate));
+            envelope = peak + coefficient * (envelope - peak);
+
+            const auto level = juce::Decibels::gainToDecibels(envelope, -60.f);
+            offsets[(size_t)chunk] = juce::jlimit(-maxOffset, maxOffset, amount * 0.5f * (level - referenceLevel));
+        }
+    }
+    else
+    {
+        envelope = 0;
+        std::fill(offsets.begin(), offsets.begin() + numChunks, 0.f);
+    }
+
+    const auto newLookahead = calculateLookaheadSamples(settings);
+
+    if(newLookahead != getLookaheadSamples())
+    {
+        if(newLookahead == 0)
+            delay.reset();
+
+        lookaheadSamples.store(newLookahead, std::memory_order_relaxed);
+    }
+
+    if(newLookahead > 0)
+    {
+        delay.setDelay((float)newLookahead);
+
+        auto block = juce::dsp::AudioBlock<float>(buffer);
+        delay.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    DynamicDrive.h
+    Created: 24 Oct 2026 10:48:03am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+// Follows the input level and turns it into an offset for the distortion's drive, so the drive can
+// go up with the input (positive amount) or down to hold the character steady (negative). The
+// envelope is taken per chunkSize samples from the peak of both channels together, which keeps
+// the rectifying and linking in FloatVectorOperations and leaves one multiply-add per chunk for
+// the attack and release. The audio can be delayed by a few milliseconds of lookahead so the
+// drive moves ahead of a transient rather than after it; that delay is the plugin's latency.
+class DynamicDrive
+{
+public:
+    static constexpr int chunkSize = 32;
+    static constexpr double maxLookaheadSeconds = 0.01;
+    static constexpr float referenceLevel = -18.f;  // dBFS where the offset is 0
+    static constexpr float maxOffset = 20.f;        // dB
+
+    struct Settings
+    {
+        float amount {0};       // %, -100 to 100
+        float attackMs {5};
+        float releaseMs {100};
+        float lookaheadMs {0};
+    };
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // Called with the undelayed input at the start of every block, even when the distortion is
+    // off, so the latency never changes under the host. Works out one drive offset per chunk,
+    // then delays the buffer in place by the lookahead.
+    void process(juce::AudioBuffer<float>& buffer, const Settings& settings) noexcept;
+
+    // what the lookahead will be with these settings, and what it was in the last block
+    int calculateLookaheadSamples(const Settings& settings) const noexcept;
+    int getLookaheadSamples() const noexcept { return lookaheadSamples.load(std::memory_order_relaxed); }
+
+    // the offset in dB for the chunk starting at chunk * chunkSize in the last block
+    float getDriveOffset(int chunk) const noexcept { return offsets[(size_t)juce::jlimit(0, numChunks - 1, chunk)]; }
+    int getNumChunks() const noexcept { return numChunks; }
+
+private:
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> delay;
+    std::vector<float> offsets;
+    int numChunks {0};
+
+    double sampleRate {44100.0};
+    float envelope {0};
+    std::atomic<int> lookaheadSamples {0};
+};
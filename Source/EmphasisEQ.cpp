@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    EmphasisEQ.cpp
+    Created: 24 Oct 2026 3:26:50pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "EmphasisEQ.h"
+
+void EmphasisEQ::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    pre.prepare((int)spec.numChannels);
+    post.prepare((int)spec.numChannels);
+    pre.setNumStages(2);
+    post.setNumStages(2);
+
+    // recalculated for the new rate on the next setParameters()
+    emphasis = 0;
+    frequency = 0;
+}
+
+void EmphasisEQ::reset()
+{
+    pre.reset();
+    post.reset();
+}
+
+void EmphasisEQ::setParameters(float emphasisDb, float pivotFrequency) noexcept
+{
+    if(emphasisDb == emphasis && pivotFrequency == frequency)
+        return;
+
+    if(emphasis == 0.f && emphasisDb != 0.f)
+        reset();
+
+    emphasis = emphasisDb;
+    frequency = pivotFrequency;
+
+    if(!isActive())
+        return;
+
+    const auto g = std::tan(juce::MathConstants<double>::pi * juce::jlimit(10.0, sampleRate * 0.45, (double)frequency) / sampleRate);
+    const auto twoR = 2.0 * damping;
+
+    // SVFilter's gain term, 10^(dB/20) - 1, for half the emphasis on each shelf
+    const auto lowGain = std::pow(10.0, -emphasisDb * 0.025) - 1.0;
+    const auto highGain = std::pow(10.0, emphasisDb * 0.025) - 1.0;
+
+    // low shelf: 1 + K / (s^2 + 2Rs + 1), high shelf: 1 + K s^2 / (s^2 + 2Rs + 1)
+    const auto lowShelf = BiquadCascade::fromAnalog(1.0 + lowGain, twoR, 1.0, 1.0, twoR, 1.0, g);
+    const auto highShelf = BiquadCascade::fromAnalog(1.0, twoR, 1.0 + highGain, 1.0, twoR, 1.0, g);
+
+    pre.setStage(0, lowShelf);
+    pre.setStage(1, highShelf);
+    post.setStage(0, BiquadCascade::inverse(lowShelf));
+    post.setStage(1, BiquadCascade::inverse(highShelf));
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    EmphasisEQ.h
+    Created: 24 Oct 2026 3:26:50pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+// Tilts the signal into the distortion and back out again: a low shelf cut and high shelf boost
+// (or the other way round) around a pivot before the shaper, and the exact inverse after it. With
+// the drive at 0 the two cancel, with drive the tilted side of the spectrum clips first.
+//
+// The shelves are built the way viator_dsp::SVFilter builds its shelves (input + gain * lowpass or
+// highpass of a state variable core), but around a Butterworth core rather than SVFilter's own
+// Q, and turned into biquads so the pre and post pair each run as one BiquadCascade pass.
+// Coefficients are only worked out again when a setting changes.
+class EmphasisEQ
+{
+public:
+    // R in s^2 + 2Rs + 1, 1/sqrt(2) makes the core a Butterworth pair (Q = 1 / 2R = 0.7071)
+    static constexpr double damping = 0.7071;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // emphasis in dB, positive lifts the highs going in
+    void setParameters(float emphasisDb, float pivotFrequency) noexcept;
+
+    bool isActive() const noexcept { return emphasis != 0.f; }
+
+    void processPre(const juce::dsp::AudioBlock<float>& block) noexcept  { if(isActive()) pre.process(block); }
+    void processPost(const juce::dsp::AudioBlock<float>& block) noexcept { if(isActive()) post.process(block); }
+
+private:
+    BiquadCascade pre, post;
+
+    double sampleRate {44100.0};
+    float emphasis {0}, frequency {0};
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "HostLoadMonitor.h"
 
 namespace Gui
 {
@@ -112,6 +113,11 @@ namespace Gui
             repaint();
         }
         
+        void setRefreshRate(int hz)
+        {
+            startTimerHz(hz);
+        }
+        
         void toggleMeterEnablement(bool enabled)
         {
             toggleLights = enabled;
@@ -124,4 +130,35 @@ namespace Gui
         const int totalBulbNo = 10;
         bool toggleLights = true;
     };
+
+
+    // p50 / p99 / max of processBlock()'s share of the deadline, red once the worst block gets close
+    class LoadReadout : public Component, public Timer
+    {
+    public:
+        LoadReadout(const HostLoadMonitor& m) : monitor(m)
+        {
+            startTimerHz(2);
+        }
+        
+        void paint(Graphics& g) override
+        {
+            const auto stats = monitor.getStats();
+            
+            g.setColour(stats.max > 0.8 ? Colours::red : Colours::white);
+            g.setFont(jmin(12.f, (float)getHeight()));
+            g.drawFittedText("CPU " + String(roundToInt(stats.p50 * 100.0)) + " / "
+                             + String(roundToInt(stats.p99 * 100.0)) + " / "
+                             + String(roundToInt(stats.max * 100.0)) + "%",
+                             getLocalBounds(), Justification::centred, 1);
+        }
+        
+        void timerCallback() override
+        {
+            repaint();
+        }
+        
+    private:
+        const HostLoadMonitor& monitor;
+    };
 }
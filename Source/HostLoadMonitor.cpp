@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    HostLoadMonitor.cpp
+    Created: 21 Oct 2026 1:46:55pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "HostLoadMonitor.h"
+
+HostLoadMonitor::HostLoadMonitor()
+{
+    for(auto& load : loads)
+        load.store(0.f, std::memory_order_relaxed);
+}
+
+void HostLoadMonitor::reset(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate.store(newSampleRate);
+    measurer.reset(newSampleRate, maximumBlockSize);
+    numWritten.store(0);
+    lastLoad.store(0);
+}
+
+void HostLoadMonitor::registerBlock(double seconds, int numSamples) noexcept
+{
+    if(numSamples <= 0)
+        return;
+
+    measurer.registerRenderTime(seconds * 1000.0, numSamples);
+
+    const auto deadline = numSamples / sampleRate.load(std::memory_order_relaxed);
+    const auto index = numWritten.load(std::memory_order_relaxed);
+
+    const auto load = (float)(seconds / deadline);
+    lastLoad.store(load, std::memory_order_relaxed);
+    loads[index % ringSize].store(load, std::memory_order_relaxed);
+    numWritten.store(index + 1, std::memory_order_release);
+}
+
+HostLoadMonitor::Stats HostLoadMonitor::getStats() const
+{
+    Stats stats;
+    stats.average = measurer.getLoadAsProportion();
+    stats.overruns = measurer.getXRunCount();
+
+    // the audio thread may overwrite a few entries while we copy, which only shifts the window
+    const auto written = numWritten.load(std::memory_order_acquire);
+    stats.numBlocks = (int)juce::jmin(written, (juce::uint32)ringSize);
+
+    if(stats.numBlocks == 0)
+        return stats;
+
+    std::vector<float> sorted((size_t)stats.numBlocks);
+    for(size_t i = 0; i < sorted.size(); ++i)
+        sorted[i] = loads[i].load(std::memory_order_relaxed);
+
+    std::sort(sorted.begin(), sorted.end());
+
+    auto percentile = [&sorted](double p)
+    {
+        return (double)sorted[(size_t)juce::jlimit(0, (int)sorted.size() - 1, (int)std::ceil(p * (double)sorted.size()) - 1)];
+    };
+
+    stats.p50 = percentile(0.5);
+    stats.p99 = percentile(0.99);
+    stats.max = sorted.back();
+    return stats;
+}
+
+juce::String HostLoadMonitor::toString(const Stats& stats)
+{
+    return "p50 " + juce::String(stats.p50 * 100.0, 1) + "%, p99 " + juce::String(stats.p99 * 100.0, 1)
+         + "%, max " + juce::String(stats.max * 100.0, 1) + "% of the deadline over " + juce::String(stats.numBlocks)
+         + " blocks, " + juce::String(stats.overruns) + " overruns";
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    HostLoadMonitor.h
+    Created: 21 Oct 2026 1:46:55pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// How close processBlock() runs to the host's deadline. Every block's time is taken as a fraction
+// of numSamples / sampleRate (1.0 means the block took as long as it lasts) and written to a lock
+// free ring, which the editor or an offline render can turn into percentiles. The smoothed figure
+// and the overrun count come from juce::AudioProcessLoadMeasurer.
+class HostLoadMonitor
+{
+public:
+    // the last ringSize blocks make up the percentiles, about 20 seconds of 512 sample blocks at 48kHz
+    static constexpr int ringSize = 2048;
+
+    struct Stats
+    {
+        int numBlocks {0};
+        double average {0};    // AudioProcessLoadMeasurer's smoothed load
+        double p50 {0}, p99 {0}, max {0};
+        int overruns {0};
+    };
+
+    HostLoadMonitor();
+
+    // from prepareToPlay()
+    void reset(double sampleRate, int maximumBlockSize);
+
+    // audio thread only
+    void registerBlock(double seconds, int numSamples) noexcept;
+
+    Stats getStats() const;
+
+    // the most recent block's share of its deadline
+    double getLastLoad() const noexcept { return lastLoad.load(std::memory_order_relaxed); }
+
+    static juce::String toString(const Stats& stats);
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(HostLoadMonitor& m, int samples) noexcept
+            : monitor(m), numSamples(samples), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedTimer() noexcept
+        {
+            monitor.registerBlock(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start), numSamples);
+        }
+
+    private:
+        HostLoadMonitor& monitor;
+        int numSamples;
+        juce::int64 start;
+    };
+
+private:
+    juce::AudioProcessLoadMeasurer measurer;
+    std::atomic<double> sampleRate {44100.0};
+
+    std::array<std::atomic<float>, ringSize> loads;
+    std::atomic<juce::uint32> numWritten {0};
+    std::atomic<float> lastLoad {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HostLoadMonitor)
+};
@@ -9,25 +9,19 @@
 */
 
 #include "ImageAnalyser.h"
+#include "ImagePatchModel.h"
+#include <fstream>
 
 using namespace cv;
 
 std::vector<float> ImageAnalyser::processImage(std::string path)
 {
-    Mat img = imread(path);
-    Mat imgHSV, imgHLS;
-    
-    cvtColor(img, imgHSV, COLOR_BGR2HSV);
-    cvtColor(img, imgHLS, COLOR_BGR2HLS);
-    
-//    Scalar avg = cv::mean(img);
-//    Scalar avg2 = cv::mean(imgHLS);
-    Scalar avg3 = cv::mean(imgHSV);
-    
+    auto stats = analyseImage(path);
+
     std::vector<float> HSVvalues;
-    HSVvalues.push_back(avg3[0]);
-    HSVvalues.push_back(avg3[1]);
-    HSVvalues.push_back(avg3[2]);
+    HSVvalues.push_back(stats.hueMean);
+    HSVvalues.push_back(stats.saturationMean);
+    HSVvalues.push_back(stats.valueMean);
     
 //    imshow("Image", img);
 //    imshow("ImageHSV", imgHSV);
@@ -77,6 +71,205 @@ std::vector<float> ImageAnalyser::processImage(std::string path)
     return HSVvalues;
 }
 
+HSVStatistics ImageAnalyser::analyseImage(const std::string& path)
+{
+    Mat img = decodeReduced(path);
+    
+    if(img.empty())
+    {
+        return {};
+    }
+    
+    return computeStatistics(img);
+}
+
+Mat ImageAnalyser::decodeReduced(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uchar> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    
+    if(bytes.empty())
+    {
+        return {};
+    }
+    
+    // jpegs can be decoded straight to a 1/2, 1/4 or 1/8 scale image, which is plenty for colour
+    // statistics. The size comes from the header so we only ever decode once, at the smallest
+    // scale that still leaves minAnalysisSize pixels on the short side.
+    if(auto size = readJpegSize(bytes); size.area() > 0)
+    {
+        const int shortSide = std::min(size.width, size.height);
+        const int flag = shortSide / 8 >= minAnalysisSize ? IMREAD_REDUCED_COLOR_8
+                       : shortSide / 4 >= minAnalysisSize ? IMREAD_REDUCED_COLOR_4
+                       : shortSide / 2 >= minAnalysisSize ? IMREAD_REDUCED_COLOR_2
+                       : IMREAD_COLOR;
+        
+        return imdecode(bytes, flag);
+    }
+    
+    // other formats have no cheaper reduced decode, so decode at full size and area average
+    // down to the same scale the jpeg path would have picked
+    Mat img = imdecode(bytes, IMREAD_COLOR);
+    
+    if(img.empty())
+    {
+        return img;
+    }
+    
+    const int shortSide = std::min(img.cols, img.rows);
+    int scale = 8;
+    while(scale > 1 && shortSide / scale < minAnalysisSize)
+    {
+        scale /= 2;
+    }
+    
+    if(scale > 1)
+    {
+        Mat reduced;
+        resize(img, reduced, Size((img.cols + scale - 1) / scale, (img.rows + scale - 1) / scale), 0, 0, INTER_AREA);
+        return reduced;
+    }
+    
+    return img;
+}
+
+Size ImageAnalyser::readJpegSize(const std::vector<uchar>& bytes)
+{
+    if(bytes.size() < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8)
+    {
+        return {};
+    }
+    
+    // walks the marker segments up to the first start-of-frame, which holds the image size
+    size_t pos = 2;
+    while(pos + 9 < bytes.size())
+    {
+        if(bytes[pos] != 0xFF)
+        {
+            return {};
+        }
+        
+        const auto marker = bytes[pos + 1];
+        const size_t length = (bytes[pos + 2] << 8) | bytes[pos + 3];
+        
+        const bool isStartOfFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if(isStartOfFrame)
+        {
+            return { (bytes[pos + 7] << 8) | bytes[pos + 8], (bytes[pos + 5] << 8) | bytes[pos + 6] };
+        }
+        
+        pos += 2 + length;
+    }
+    
+    return {};
+}
+
+HSVStatistics ImageAnalyser::computeStatistics(const Mat& bgr)
+{
+    CV_Assert(bgr.type() == CV_8UC3);
+    
+    // opencv's 8 bit hue is degrees / 2, so 180 steps around the circle
+    static const auto hueAngles = []()
+    {
+        std::array<std::pair<double, double>, 180> table;
+        for(int h = 0; h < 180; ++h)
+        {
+            auto radians = h * 2.0 * CV_PI / 180.0;
+            table[h] = { std::cos(radians), std::sin(radians) };
+        }
+        return table;
+    }();
+    
+    HSVStatistics stats;
+    stats.analysedWidth = bgr.cols;
+    stats.analysedHeight = bgr.rows;
+    
+    double hueCos = 0, hueSin = 0, hueWeight = 0;
+    uint64_t satSum = 0, satSumSq = 0, valSum = 0, valSumSq = 0;
+    std::array<double, HSVStatistics::hueBins> hueHist {};
+    std::array<uint64_t, HSVStatistics::levelBins> satHist {}, valHist {};
+    
+    // converts each pixel to HSV in registers (same maths as COLOR_BGR2HSV) and accumulates
+    // everything in the one pass, so the converted image never exists in memory
+    for(int row = 0; row < bgr.rows; ++row)
+    {
+        const auto* pixel = bgr.ptr<uchar>(row);
+        
+        for(int col = 0; col < bgr.cols; ++col, pixel += 3)
+        {
+            const int b = pixel[0], g = pixel[1], r = pixel[2];
+            const int v = std::max({r, g, b});
+            const int diff = v - std::min({r, g, b});
+            
+            const int s = v == 0 ? 0 : (diff * 255 + v / 2) / v;
+            
+            int h = 0;
+            if(diff != 0)
+            {
+                float hue;
+                if(v == r)
+                    hue = 60.f * (g - b) / diff;
+                else if(v == g)
+                    hue = 120.f + 60.f * (b - r) / diff;
+                else
+                    hue = 240.f + 60.f * (r - g) / diff;
+                
+                if(hue < 0.f)
+                    hue += 360.f;
+                
+                h = cvRound(hue * 0.5f);
+                if(h >= 180)
+                    h -= 180;
+            }
+            
+            // greys have no meaningful hue, so each pixel votes for its hue by how saturated it is
+            const double weight = s / 255.0;
+            hueCos += weight * hueAngles[h].first;
+            hueSin += weight * hueAngles[h].second;
+            hueWeight += weight;
+            hueHist[h * HSVStatistics::hueBins / 180] += weight;
+            
+            satSum += s;
+            satSumSq += s * s;
+            valSum += v;
+            valSumSq += v * v;
+            satHist[s * HSVStatistics::levelBins / 256]++;
+            valHist[v * HSVStatistics::levelBins / 256]++;
+        }
+    }
+    
+    const double numPixels = (double)bgr.total();
+    
+    if(hueWeight > 0.0)
+    {
+        // circular mean, so a picture of reds either side of 0/179 averages to red rather than cyan
+        auto meanAngle = std::atan2(hueSin, hueCos) * 180.0 / CV_PI;
+        if(meanAngle < 0.0)
+            meanAngle += 360.0;
+        
+        stats.hueMean = (float)std::fmod(meanAngle * 0.5, 180.0);
+        stats.hueConcentration = (float)(std::sqrt(hueCos * hueCos + hueSin * hueSin) / hueWeight);
+        
+        for(int i = 0; i < HSVStatistics::hueBins; ++i)
+        {
+            stats.hueHistogram[i] = (float)(hueHist[i] / hueWeight);
+        }
+    }
+    
+    stats.saturationMean = (float)(satSum / numPixels);
+    stats.valueMean = (float)(valSum / numPixels);
+    stats.saturationVariance = (float)(satSumSq / numPixels - stats.saturationMean * (double)stats.saturationMean);
+    stats.valueVariance = (float)(valSumSq / numPixels - stats.valueMean * (double)stats.valueMean);
+    
+    for(int i = 0; i < HSVStatistics::levelBins; ++i)
+    {
+        stats.saturationHistogram[i] = (float)(satHist[i] / numPixels);
+        stats.valueHistogram[i] = (float)(valHist[i] / numPixels);
+    }
+    
+    return stats;
+}
+
 std::string ImageAnalyser::getAnalysisOutputString(int hue, int saturation, int value)
 {
     std::string output = "Distortion type determined by hue: ";
@@ -134,3 +327,103 @@ std::string ImageAnalyser::getAnalysisOutputString(int hue, int saturation, int
 
     return output;
 }
+
+std::string ImageAnalyser::getAnalysisOutputString(const ImagePatch& patch, const ImageFeatures& features)
+{
+    auto output = getAnalysisOutputString((int)features.hsv.hueMean, (int)patch.drive, (int)features.hsv.valueMean);
+    
+    output.append("\n\nMix set by image contrast: ");
+    output += std::to_string((int)patch.mix);
+    output.append("%");
+    
+    output.append("\n\nEdge density: ");
+    output += std::to_string((int)(features.edgeDensity * 100.f));
+    output.append("%, spatial frequency: ");
+    output += std::to_string((int)(features.spatialFrequency * 100.f));
+    output.append("%");
+    
+    return output;
+}
+
+ImageFeatures ImageAnalyser::extractFeatures(const std::string& path)
+{
+    Mat img = decodeReduced(path);
+    
+    if(img.empty())
+    {
+        return {};
+    }
+    
+    return extractImageFeatures(img, computeStatistics(img));
+}
+
+ImagePatch ImageAnalyser::generatePatch(const ImageFeatures& features)
+{
+    if(patchModel != nullptr && patchModel->isLoaded())
+    {
+        return patchModel->predict(features);
+    }
+    
+    return generateHuePatch(features);
+}
+
+ImagePatch ImageAnalyser::generateHuePatch(const ImageFeatures& features)
+{
+    ImagePatch patch;
+    
+    // indices into the processor's "distortion mode" choices
+    switch((int)features.hsv.hueMean)
+    {
+        case 0 ... 15 :
+        case 164 ... 179 :
+            patch.distortionMode = 3;
+        break;
+            
+        case 105 ... 132  :
+            patch.distortionMode = 2;
+        break;
+            
+        case 133 ... 163 :
+            patch.distortionMode = 1;
+        break;
+            
+        case 46 ... 76 :
+            patch.distortionMode = 6;
+        break;
+            
+        case 16 ... 45 :
+            patch.distortionMode = 4;
+        break;
+            
+        case 77 ... 104 :
+            patch.distortionMode = 5;
+        break;
+    }
+    
+    // saturation still sets most of the drive, busy images with lots of edges push it further
+    auto driveAmount = 0.7f * features.hsv.saturationMean / 255.f + 0.3f * std::min(1.f, features.edgeDensity * 4.f);
+    patch.drive = std::round(std::clamp(driveAmount, 0.f, 1.f) * 40.f) * 0.5f;
+    
+    // flat images blend in less of the distorted signal than high contrast ones
+    patch.mix = std::round(std::clamp(25.f + features.contrast * 250.f, 0.f, 100.f));
+    
+    switch((int)features.hsv.valueMean)
+    {
+        case 0 ... 85 :
+            patch.lowCutFreq = 1.f;
+            patch.highCutFreq = 400.f;
+        break;
+            
+        case 86 ... 170  :
+            patch.lowCutFreq = 401.f;
+            patch.highCutFreq = 2000.f;
+        break;
+            
+        case 171 ... 255 :
+            patch.lowCutFreq = 2001.f;
+            patch.highCutFreq = 22000.f;
+        break;
+    }
+    
+    return patch;
+}
@@ -14,14 +14,34 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include <iostream>
+#include "ImageFeatures.h"
+
+class ImagePatchModel;
 
 struct ImageAnalyser
 {
 public:
     std::vector<float> processImage(std::string path);
+    HSVStatistics analyseImage(const std::string& path);
+    ImageFeatures extractFeatures(const std::string& path);
+    ImagePatch generatePatch(const ImageFeatures& features);
+    ImagePatch generateHuePatch(const ImageFeatures& features);
+    
+    // when a loaded model is set generatePatch() uses it instead of the hue mapping,
+    // the model isn't owned and has to outlive the analyser
+    void setPatchModel(const ImagePatchModel* model) { patchModel = model; }
     void setParameterValues();
     std::string getAnalysisOutputString(int hue, int saturation, int value);
-    
+    std::string getAnalysisOutputString(const ImagePatch& patch, const ImageFeatures& features);
+
 private:
-    
+    // smallest side we accept from a reduced decode before stepping up to a larger scale
+    static constexpr int minAnalysisSize = 64;
+
+    const ImagePatchModel* patchModel = nullptr;
+
+    cv::Mat decodeReduced(const std::string& path);
+    // width and height from a jpeg's frame header, empty if the data isn't a jpeg
+    static cv::Size readJpegSize(const std::vector<uchar>& bytes);
+    HSVStatistics computeStatistics(const cv::Mat& bgr);
 };
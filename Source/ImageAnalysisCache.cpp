@@ -0,0 +1,263 @@
+/*
+  ==============================================================================
+
+    ImageAnalysisCache.cpp
+    Created: 19 Oct 2026 2:41:37pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "ImageAnalysisCache.h"
+
+static_assert(std::is_trivially_copyable_v<ImageFeatures> && std::is_trivially_copyable_v<ImagePatch>,
+              "cache entries are written to disk as raw bytes");
+
+namespace
+{
+    constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    inline uint64_t read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    inline uint32_t read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    inline uint64_t xxRound(uint64_t acc, uint64_t input)
+    {
+        acc += input * prime2;
+        return rotl(acc, 31) * prime1;
+    }
+
+    inline uint64_t xxMerge(uint64_t acc, uint64_t value)
+    {
+        acc ^= xxRound(0, value);
+        return acc * prime1 + prime4;
+    }
+
+    // XXH64, little endian only
+    uint64_t xxHash64(const void* data, size_t length, uint64_t seed)
+    {
+        auto* p = static_cast<const uint8_t*>(data);
+        const auto* end = p + length;
+        uint64_t h;
+
+        if(length >= 32)
+        {
+            uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+
+            for(const auto* limit = end - 32; p <= limit; p += 32)
+            {
+                v1 = xxRound(v1, read64(p));
+                v2 = xxRound(v2, read64(p + 8));
+                v3 = xxRound(v3, read64(p + 16));
+                v4 = xxRound(v4, read64(p + 24));
+            }
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = xxMerge(h, v1);
+            h = xxMerge(h, v2);
+            h = xxMerge(h, v3);
+            h = xxMerge(h, v4);
+        }
+        else
+        {
+            h = seed + prime5;
+        }
+
+        h += (uint64_t)length;
+
+        for(; p + 8 <= end; p += 8)
+            h = rotl(h ^ xxRound(0, read64(p)), 27) * prime1 + prime4;
+
+        if(p + 4 <= end)
+        {
+            h = rotl(h ^ (read32(p) * prime1), 23) * prime2 + prime3;
+            p += 4;
+        }
+
+        for(; p < end; ++p)
+            h = rotl(h ^ (*p * prime5), 11) * prime1;
+
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        h ^= h >> 32;
+        return h;
+    }
+}
+
+ImageAnalysisCache::ImageAnalysisCache() : ImageAnalysisCache(getDefaultCacheFolder())
+{
+}
+
+ImageAnalysisCache::ImageAnalysisCache(const juce::File& cacheFolder, size_t maxEntriesInMemory)
+: folder(cacheFolder), maxEntries(juce::jmax((size_t)1, maxEntriesInMemory))
+{
+}
+
+juce::File ImageAnalysisCache::getDefaultCacheFolder()
+{
+    // sits alongside the distortionPresets folder
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userDesktopDirectory)
+        .getChildFile("distortionAnalysisCache");
+}
+
+uint64_t ImageAnalysisCache::getKeyForFile(const juce::File& imageFile)
+{
+    const auto size = (uint64_t)imageFile.getSize();
+    const auto modified = (uint64_t)imageFile.getLastModificationTime().toMilliseconds();
+    const auto seed = size * prime1 ^ modified;
+    
+    juce::MemoryMappedFile mapped(imageFile, juce::MemoryMappedFile::readOnly);
+    if(mapped.getData() != nullptr)
+    {
+        return xxHash64(mapped.getData(), mapped.getSize(), seed);
+    }
+    
+    juce::MemoryBlock data;
+    imageFile.loadFileAsData(data);
+    return xxHash64(data.getData(), data.getSize(), seed);
+}
+
+ImageAnalysisCache::Entry ImageAnalysisCache::getOrAnalyse(const juce::File& imageFile, ImageAnalyser& analyser)
+{
+    const auto key = getKeyForFile(imageFile);
+    
+    Entry entry;
+    if(lookup(key, entry))
+    {
+        // features are what's expensive, the patch is cheap to redo and depends on the
+        // analyser's current model rather than whatever produced the cached copy
+        entry.patch = analyser.generatePatch(entry.features);
+        return entry;
+    }
+    
+    entry.features = analyser.extractFeatures(imageFile.getFullPathName().toStdString());
+    entry.patch = analyser.generatePatch(entry.features);
+    store(key, entry);
+    
+    return entry;
+}
+
+bool ImageAnalysisCache::lookup(uint64_t key, Entry& result)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            recent.splice(recent.begin(), recent, it->second);
+            result = it->second->second;
+            return true;
+        }
+    }
+    
+    if(readFromDisk(key, result))
+    {
+        const juce::ScopedLock sl(lock);
+        insertRecent(key, result);
+        return true;
+    }
+    
+    return false;
+}
+
+void ImageAnalysisCache::store(uint64_t key, const Entry& entry)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        insertRecent(key, entry);
+    }
+    
+    writeToDisk(key, entry);
+}
+
+void ImageAnalysisCache::insertRecent(uint64_t key, const Entry& entry)
+{
+    auto it = index.find(key);
+    if(it != index.end())
+    {
+        it->second->second = entry;
+        recent.splice(recent.begin(), recent, it->second);
+        return;
+    }
+    
+    recent.emplace_front(key, entry);
+    index[key] = recent.begin();
+    
+    while(recent.size() > maxEntries)
+    {
+        index.erase(recent.back().first);
+        recent.pop_back();
+    }
+}
+
+juce::File ImageAnalysisCache::getFileForKey(uint64_t key) const
+{
+    return folder.getChildFile(juce::String::toHexString((juce::int64)key).paddedLeft('0', 16) + ".analysis");
+}
+
+bool ImageAnalysisCache::readFromDisk(uint64_t key, Entry& result) const
+{
+    juce::FileInputStream in(getFileForKey(key));
+    if(!in.openedOk())
+    {
+        return false;
+    }
+    
+    if(in.readInt() != (int)formatVersion
+       || in.readInt() != (int)sizeof(ImageFeatures)
+       || in.readInt() != (int)sizeof(ImagePatch))
+    {
+        return false;
+    }
+    
+    Entry entry;
+    if(in.read(&entry.features, sizeof(ImageFeatures)) != (int)sizeof(ImageFeatures)
+       || in.read(&entry.patch, sizeof(ImagePatch)) != (int)sizeof(ImagePatch))
+    {
+        return false;
+    }
+    
+    result = entry;
+    return true;
+}
+
+void ImageAnalysisCache::writeToDisk(uint64_t key, const Entry& entry) const
+{
+    if(!folder.createDirectory().wasOk())
+    {
+        return;
+    }
+    
+    // write to a temp file and move it into place so a crash can't leave a half written entry
+    juce::TemporaryFile temp(getFileForKey(key));
+    
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if(!out.openedOk())
+        {
+            return;
+        }
+        
+        out.writeInt((int)formatVersion);
+        out.writeInt((int)sizeof(ImageFeatures));
+        out.writeInt((int)sizeof(ImagePatch));
+        out.write(&entry.features, sizeof(ImageFeatures));
+        out.write(&entry.patch, sizeof(ImagePatch));
+        out.flush();
+        
+        if(out.getStatus().failed())
+        {
+            return;
+        }
+    }
+    
+    temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    ImageAnalysisCache.h
+    Created: 19 Oct 2026 2:41:37pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <unordered_map>
+#include "ImageAnalyser.h"
+
+// Remembers analysis results for images we've already seen, keyed by a hash of the file's
+// contents, size and modification time. Recent results live in memory, everything else is
+// kept on disk next to the presets folder so it survives between sessions.
+class ImageAnalysisCache
+{
+public:
+    struct Entry
+    {
+        ImageFeatures features;
+        ImagePatch patch;
+    };
+    
+    ImageAnalysisCache();
+    explicit ImageAnalysisCache(const juce::File& cacheFolder, size_t maxEntriesInMemory = 64);
+    
+    // analyses the image only if there's no cached result for it
+    Entry getOrAnalyse(const juce::File& imageFile, ImageAnalyser& analyser);
+    
+    bool lookup(uint64_t key, Entry& result);
+    void store(uint64_t key, const Entry& entry);
+    
+    static uint64_t getKeyForFile(const juce::File& imageFile);
+    static juce::File getDefaultCacheFolder();
+    
+private:
+    // bump this whenever ImageFeatures or the patch mapping changes so stale results are ignored
+    static constexpr uint32_t formatVersion = 1;
+    
+    juce::File folder;
+    size_t maxEntries;
+    
+    using LruList = std::list<std::pair<uint64_t, Entry>>;
+    LruList recent;
+    std::unordered_map<uint64_t, LruList::iterator> index;
+    juce::CriticalSection lock;
+    
+    void insertRecent(uint64_t key, const Entry& entry);
+    juce::File getFileForKey(uint64_t key) const;
+    bool readFromDisk(uint64_t key, Entry& result) const;
+    void writeToDisk(uint64_t key, const Entry& entry) const;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageAnalysisCache)
+};
@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    ImageFeatures.cpp
+    Created: 19 Oct 2026 10:05:12am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "ImageFeatures.h"
+#include <opencv2/imgproc.hpp>
+#include <limits>
+#include <numeric>
+
+using namespace cv;
+
+namespace
+{
+    // gradient magnitude (on 0-1 luminance) above which a pixel counts as an edge
+    constexpr float edgeThreshold = 0.25f;
+    constexpr int tileRows = 32;
+    constexpr int maxKMeansSamples = 4096;
+
+    struct TileSums
+    {
+        double lumaSum {0}, lumaSumSq {0};
+        double rowDiffSq {0}, colDiffSq {0};
+        double edgePixels {0}, interiorPixels {0};
+    };
+
+    struct SpatialTileBody : ParallelLoopBody
+    {
+        SpatialTileBody(const Mat& g, std::vector<TileSums>& t) : grey(g), tiles(t) {}
+
+        void operator()(const Range& range) const override
+        {
+            for(int tile = range.start; tile < range.end; ++tile)
+            {
+                auto& sums = tiles[tile];
+                const int firstRow = tile * tileRows;
+                const int lastRow = std::min(firstRow + tileRows, grey.rows);
+
+                for(int row = firstRow; row < lastRow; ++row)
+                {
+                    const auto* above = grey.ptr<uchar>(std::max(row - 1, 0));
+                    const auto* line = grey.ptr<uchar>(row);
+                    const auto* below = grey.ptr<uchar>(std::min(row + 1, grey.rows - 1));
+                    const bool interiorRow = row > 0 && row < grey.rows - 1;
+
+                    for(int col = 0; col < grey.cols; ++col)
+                    {
+                        const float p = line[col] / 255.f;
+                        sums.lumaSum += p;
+                        sums.lumaSumSq += p * p;
+
+                        if(col > 0)
+                        {
+                            const float d = (line[col] - line[col - 1]) / 255.f;
+                            sums.rowDiffSq += d * d;
+                        }
+                        if(row > 0)
+                        {
+                            const float d = (line[col] - above[col]) / 255.f;
+                            sums.colDiffSq += d * d;
+                        }
+
+                        if(interiorRow && col > 0 && col < grey.cols - 1)
+                        {
+                            const int gx = (above[col + 1] + 2 * line[col + 1] + below[col + 1])
+                                         - (above[col - 1] + 2 * line[col - 1] + below[col - 1]);
+                            const int gy = (below[col - 1] + 2 * below[col] + below[col + 1])
+                                         - (above[col - 1] + 2 * above[col] + above[col + 1]);
+
+                            // a full scale step gives 4 * 255 from the Sobel kernel
+                            const float magnitude = std::sqrt((float)(gx * gx + gy * gy)) / (4.f * 255.f);
+
+                            sums.interiorPixels += 1;
+                            if(magnitude > edgeThreshold)
+                                sums.edgePixels += 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        const Mat& grey;
+        std::vector<TileSums>& tiles;
+    };
+
+    void findDominantColours(const Mat& bgr, ImageFeatures& features)
+    {
+        const int numPixels = (int)bgr.total();
+        const int step = std::max(1, numPixels / maxKMeansSamples);
+        const int numSamples = numPixels / step;
+
+        if(numSamples < ImageFeatures::numDominantColours)
+            return;
+
+        Mat samples(numSamples, 3, CV_32F);
+        const auto* pixels = bgr.ptr<Vec3b>(0);
+        const bool continuous = bgr.isContinuous();
+
+        for(int i = 0; i < numSamples; ++i)
+        {
+            const int index = i * step;
+            const auto& px = continuous ? pixels[index] : bgr.at<Vec3b>(index / bgr.cols, index % bgr.cols);
+            samples.at<float>(i, 0) = px[0];
+            samples.at<float>(i, 1) = px[1];
+            samples.at<float>(i, 2) = px[2];
+        }
+
+        // the starting labels come from our own fixed seed so the same image always produces the
+        // same patch. kmeans only touches theRNG() when it has to pick centres itself, so with
+        // initial labels and a single attempt the caller's thread RNG is left alone.
+        // Each sample starts on the nearest of k randomly drawn samples, which spreads the
+        // starting centres out far better than uniformly random labels would.
+        RNG rng(0x5e47);
+        std::array<Vec3f, ImageFeatures::numDominantColours> seeds;
+        for(auto& seed : seeds)
+            seed = *samples.ptr<Vec3f>(rng.uniform(0, numSamples));
+
+        Mat labels(numSamples, 1, CV_32S);
+        for(int i = 0; i < numSamples; ++i)
+        {
+            const auto& sample = *samples.ptr<Vec3f>(i);
+            int nearest = 0;
+            double nearestDistance = std::numeric_limits<double>::max();
+            for(int k = 0; k < ImageFeatures::numDominantColours; ++k)
+            {
+                const auto distance = norm(sample - seeds[k], NORM_L2SQR);
+                if(distance < nearestDistance)
+                {
+                    nearestDistance = distance;
+                    nearest = k;
+                }
+            }
+            labels.at<int>(i) = nearest;
+        }
+
+        Mat centres;
+        kmeans(samples,
+               ImageFeatures::numDominantColours,
+               labels,
+               TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 10, 1.0),
+               1,
+               KMEANS_USE_INITIAL_LABELS,
+               centres);
+
+        std::array<int, ImageFeatures::numDominantColours> counts {};
+        for(int i = 0; i < labels.rows; ++i)
+            counts[labels.at<int>(i)]++;
+
+        Mat centresBGR, centresHSV;
+        centres.reshape(3, centres.rows).convertTo(centresBGR, CV_8UC3);
+        cvtColor(centresBGR, centresHSV, COLOR_BGR2HSV);
+
+        std::array<int, ImageFeatures::numDominantColours> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&counts](int a, int b) { return counts[a] > counts[b]; });
+
+        for(int i = 0; i < ImageFeatures::numDominantColours; ++i)
+        {
+            const auto hsv = centresHSV.at<Vec3b>(order[i]);
+            features.dominantColours[i] = { (float)hsv[0], (float)hsv[1], (float)hsv[2] };
+            features.dominantWeights[i] = counts[order[i]] / (float)numSamples;
+        }
+    }
+
+    template<size_t N>
+    float* foldHistogram(const std::array<float, N>& source, int numBins, float* dest)
+    {
+        std::fill(dest, dest + numBins, 0.f);
+        for(size_t i = 0; i < N; ++i)
+            dest[i * numBins / N] += source[i];
+        return dest + numBins;
+    }
+}
+
+ImageFeatures extractImageFeatures(const Mat& bgr, const HSVStatistics& hsv)
+{
+    ImageFeatures features;
+    features.hsv = hsv;
+
+    if(bgr.empty())
+        return features;
+
+    Mat grey;
+    cvtColor(bgr, grey, COLOR_BGR2GRAY);
+
+    // each tile only touches its own sums, so the reduction below needs no locking
+    std::vector<TileSums> tiles((grey.rows + tileRows - 1) / tileRows);
+    parallel_for_(Range(0, (int)tiles.size()), SpatialTileBody(grey, tiles));
+
+    TileSums total;
+    for(const auto& t : tiles)
+    {
+        total.lumaSum += t.lumaSum;
+        total.lumaSumSq += t.lumaSumSq;
+        total.rowDiffSq += t.rowDiffSq;
+        total.colDiffSq += t.colDiffSq;
+        total.edgePixels += t.edgePixels;
+        total.interiorPixels += t.interiorPixels;
+    }
+
+    const double numPixels = (double)grey.total();
+    const double mean = total.lumaSum / numPixels;
+
+    features.contrast = (float)std::sqrt(std::max(0.0, total.lumaSumSq / numPixels - mean * mean));
+    features.edgeDensity = total.interiorPixels > 0 ? (float)(total.edgePixels / total.interiorPixels) : 0.f;
+    features.spatialFrequency = (float)std::sqrt(total.rowDiffSq / numPixels + total.colDiffSq / numPixels);
+
+    findDominantColours(bgr, features);
+
+    return features;
+}
+
+std::vector<float> ImageFeatures::toVector() const
+{
+    std::array<float, vectorSize> values;
+    toArray(values);
+    return { values.begin(), values.end() };
+}
+
+void ImageFeatures::toArray(std::array<float, vectorSize>& dest) const
+{
+    auto* v = dest.data();
+
+    const auto hueRadians = hsv.hueMean * 2.f * (float)CV_PI / 180.f;
+
+    *v++ = 0.5f + 0.5f * std::cos(hueRadians);
+    *v++ = 0.5f + 0.5f * std::sin(hueRadians);
+    *v++ = hsv.hueConcentration;
+    *v++ = hsv.saturationMean / 255.f;
+    *v++ = hsv.valueMean / 255.f;
+    *v++ = std::sqrt(std::max(0.f, hsv.saturationVariance)) / 128.f;
+    *v++ = std::sqrt(std::max(0.f, hsv.valueVariance)) / 128.f;
+
+    v = foldHistogram(hsv.hueHistogram, vectorHueBins, v);
+    v = foldHistogram(hsv.saturationHistogram, vectorLevelBins, v);
+    v = foldHistogram(hsv.valueHistogram, vectorLevelBins, v);
+
+    for(int i = 0; i < numDominantColours; ++i)
+    {
+        *v++ = dominantColours[i][0] / 179.f;
+        *v++ = dominantColours[i][1] / 255.f;
+        *v++ = dominantColours[i][2] / 255.f;
+        *v++ = dominantWeights[i];
+    }
+
+    *v++ = edgeDensity;
+    *v++ = contrast * 2.f;
+    *v++ = spatialFrequency;
+
+    CV_DbgAssert(v == dest.data() + vectorSize);
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    ImageFeatures.h
+    Created: 19 Oct 2026 10:05:12am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <vector>
+
+// HSV summary of an image, using OpenCV's 8 bit ranges (hue 0-179, saturation/value 0-255)
+struct HSVStatistics
+{
+    static constexpr int hueBins = 30;
+    static constexpr int levelBins = 32;
+
+    float hueMean {0}, saturationMean {0}, valueMean {0};
+
+    // mean resultant length of the hue angles, 0 = no dominant hue, 1 = a single hue
+    float hueConcentration {0};
+    float saturationVariance {0}, valueVariance {0};
+
+    // normalised so each histogram sums to 1
+    std::array<float, hueBins> hueHistogram {};
+    std::array<float, levelBins> saturationHistogram {};
+    std::array<float, levelBins> valueHistogram {};
+
+    int analysedWidth {0}, analysedHeight {0};
+};
+
+struct ImageFeatures
+{
+    static constexpr int numDominantColours = 4;
+
+    // coarse histogram sizes used in the feature vector
+    static constexpr int vectorHueBins = 12;
+    static constexpr int vectorLevelBins = 8;
+
+    static constexpr int vectorSize = 7
+                                    + vectorHueBins
+                                    + vectorLevelBins * 2
+                                    + numDominantColours * 4
+                                    + 3;
+
+    HSVStatistics hsv;
+
+    // k-means cluster centres in opencv HSV ranges, sorted by how much of the image they cover
+    std::array<std::array<float, 3>, numDominantColours> dominantColours {};
+    std::array<float, numDominantColours> dominantWeights {};
+
+    float edgeDensity {0};      // fraction of pixels on a Sobel edge, 0-1
+    float contrast {0};         // RMS contrast of the luminance, 0-0.5
+    float spatialFrequency {0}; // RMS of neighbouring pixel differences, 0-1
+
+    // flattened, roughly 0-1 normalised vector of vectorSize values
+    std::vector<float> toVector() const;
+
+    // same values as toVector() without allocating, for feeding the patch model
+    void toArray(std::array<float, vectorSize>& dest) const;
+};
+
+// the distortion settings generated from an image, in the units of the processor's parameters
+struct ImagePatch
+{
+    int distortionMode {0};     // index into the "distortion mode" choices
+    float drive {0};            // dB, 0-20
+    float mix {50};             // %, 0-100
+    float lowCutFreq {1};       // Hz
+    float highCutFreq {22000};  // Hz
+};
+
+ImageFeatures extractImageFeatures(const cv::Mat& bgr, const HSVStatistics& hsv);
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ImagePatchModel.cpp
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "ImagePatchModel.h"
+
+namespace
+{
+    float sigmoid(float x)
+    {
+        return 1.f / (1.f + std::exp(-x));
+    }
+
+    float logit(float p)
+    {
+        p = juce::jlimit(0.001f, 0.999f, p);
+        return std::log(p / (1.f - p));
+    }
+
+    // the cut knobs are skewed, so the model works on log frequency
+    float frequencyToProportion(float freq)
+    {
+        const auto clamped = juce::jlimit(ImagePatchModel::minCutFreq, ImagePatchModel::maxCutFreq, freq);
+        return std::log(clamped / ImagePatchModel::minCutFreq) / std::log(ImagePatchModel::maxCutFreq / ImagePatchModel::minCutFreq);
+    }
+
+    float proportionToFrequency(float proportion)
+    {
+        return ImagePatchModel::minCutFreq * std::pow(ImagePatchModel::maxCutFreq / ImagePatchModel::minCutFreq, proportion);
+    }
+}
+
+ImagePatchModel::ImagePatchModel()
+    : network(std::make_unique<Network>())
+{
+    int size = 0;
+    if(auto* data = BinaryData::getNamedResource("imagePatchModel_bin", size))
+    {
+        loadWeights(data, (size_t)size);
+    }
+}
+
+ImagePatchModel::ImagePatchModel(const void* weightData, size_t sizeInBytes)
+    : network(std::make_unique<Network>())
+{
+    loadWeights(weightData, sizeInBytes);
+}
+
+bool ImagePatchModel::loadWeights(const void* weightData, size_t sizeInBytes)
+{
+    loaded = network->loadWeights(weightData, sizeInBytes);
+
+    if(loaded)
+    {
+        batchNetwork = CompactNetwork({ (uint)ImageFeatures::vectorSize, (uint)hidden1Size, (uint)hidden2Size, (uint)numOutputs });
+        batchNetwork.weights(0) = network->w1;
+        batchNetwork.bias(0) = network->b1;
+        batchNetwork.weights(1) = network->w2;
+        batchNetwork.bias(1) = network->b2;
+        batchNetwork.weights(2) = network->w3;
+        batchNetwork.bias(2) = network->b3;
+    }
+
+    return loaded;
+}
+
+ImagePatch ImagePatchModel::predict(const ImageFeatures& features) const
+{
+    jassert(loaded);
+
+    std::array<float, ImageFeatures::vectorSize> values;
+    features.toArray(values);
+
+    const Network::OutputVector out = network->process(Eigen::Map<const Network::InputVector>(values.data()));
+
+    return outputsToPatch(out.data());
+}
+
+std::vector<ImagePatch> ImagePatchModel::predictBatch(const std::vector<ImageFeatures>& features) const
+{
+    jassert(loaded);
+
+    std::vector<ImagePatch> patches;
+    patches.reserve(features.size());
+
+    if(features.empty())
+        return patches;
+
+    // one column per image
+    Matrix inputs(ImageFeatures::vectorSize, (Eigen::Index)features.size());
+    std::array<float, ImageFeatures::vectorSize> values;
+
+    for(size_t i = 0; i < features.size(); ++i)
+    {
+        features[i].toArray(values);
+        inputs.col((Eigen::Index)i) = Eigen::Map<const Network::InputVector>(values.data());
+    }
+
+    // only the activation buffers are per call, the weights are shared so this stays usable from
+    // several threads without copying the network
+    CompactNetwork::Workspace workspace;
+    batchNetwork.prepare(workspace, inputs.cols());
+
+    const auto outputs = batchNetwork.forward(inputs, workspace);
+
+    for(Eigen::Index i = 0; i < outputs.cols(); ++i)
+        patches.push_back(outputsToPatch(outputs.col(i).data()));
+
+    return patches;
+}
+
+ImagePatch ImagePatchModel::outputsToPatch(const float* out)
+{
+    ImagePatch patch;
+    patch.drive = std::round(sigmoid(out[0]) * 40.f) * 0.5f;
+    patch.mix = std::round(sigmoid(out[1]) * 100.f);
+    patch.lowCutFreq = proportionToFrequency(sigmoid(out[2]));
+    patch.highCutFreq = proportionToFrequency(sigmoid(out[3]));
+
+    if(patch.lowCutFreq > patch.highCutFreq)
+        std::swap(patch.lowCutFreq, patch.highCutFreq);
+
+    // the largest score wins, no need for the softmax itself
+    patch.distortionMode = (int)(std::max_element(out + numContinuousOutputs, out + numOutputs) - (out + numContinuousOutputs));
+
+    return patch;
+}
+
+void ImagePatchModel::patchToTargets(const ImagePatch& patch, Network::OutputVector& targets)
+{
+    targets.setZero();
+    targets[0] = logit(patch.drive / 20.f);
+    targets[1] = logit(patch.mix / 100.f);
+    targets[2] = logit(frequencyToProportion(patch.lowCutFreq));
+    targets[3] = logit(frequencyToProportion(patch.highCutFreq));
+
+    if(juce::isPositiveAndBelow(patch.distortionMode, numModes))
+        targets[numContinuousOutputs + patch.distortionMode] = 1.f;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    ImagePatchModel.h
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "NeuralNetwork.h"
+#include "ImageFeatures.h"
+
+// Maps an image's feature vector straight to a patch with a small trained MLP. The weights are
+// compiled in as binary data (imagePatchModel.bin), if they're missing or don't match the
+// network's shape isLoaded() returns false and the analyser keeps using the hue mapping.
+class ImagePatchModel
+{
+public:
+    // the analytic modes, the model never picks the neural amp
+    static constexpr int numModes = 7;
+
+    // drive, mix, low cut and high cut, then one score per distortion mode
+    static constexpr int numContinuousOutputs = 4;
+    static constexpr int numOutputs = numContinuousOutputs + numModes;
+
+    static constexpr int hidden1Size = 32;
+    static constexpr int hidden2Size = 16;
+
+    using Network = FixedSizeNetwork<ImageFeatures::vectorSize, hidden1Size, hidden2Size, numOutputs>;
+
+    // loads the weights bundled with the plugin, if there are any
+    ImagePatchModel();
+    ImagePatchModel(const void* weightData, size_t sizeInBytes);
+
+    bool loadWeights(const void* weightData, size_t sizeInBytes);
+    bool isLoaded() const { return loaded; }
+
+    // doesn't allocate, safe to call from any thread once the weights are loaded
+    ImagePatch predict(const ImageFeatures& features) const;
+
+    // runs every image through the network as one matrix product per layer, much quicker than
+    // calling predict() in a loop once there are more than a handful of images
+    std::vector<ImagePatch> predictBatch(const std::vector<ImageFeatures>& features) const;
+
+    // the inverse of predict's output mapping: logits for the four continuous values and a
+    // one-hot mode, used to build training targets from presets
+    static void patchToTargets(const ImagePatch& patch, Network::OutputVector& targets);
+
+    const Network& getNetwork() const { return *network; }
+
+    static constexpr float minCutFreq = 1.f;
+    static constexpr float maxCutFreq = 22000.f;
+
+private:
+    static ImagePatch outputsToPatch(const float* outputs);
+
+    std::unique_ptr<Network> network;
+    CompactNetwork batchNetwork;
+    bool loaded = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImagePatchModel)
+};
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    ModulePriming.h
+    Created: 25 Oct 2026 10:41:08am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ModulePriming
+{
+    // A viator_dsp Clipper or Saturation's prepare() snaps its drive and mix smoothers to their
+    // targets and then starts ramping both to 0, so a module prepared mid-stream fades to dry and
+    // back over 20ms. Setting the targets before prepare() and again after leaves the smoothers
+    // sitting on them instead, for bringing a module in without it being heard to ramp.
+    template <typename Module>
+    void prepareAt(Module& module, const juce::dsp::ProcessSpec& spec, float drive, float mix)
+    {
+        using ParameterId = typename Module::ParameterId;
+
+        module.setParameter(ParameterId::kPreamp, drive);
+        module.setParameter(ParameterId::kMix, mix);
+        module.prepare(spec);
+        module.setParameter(ParameterId::kPreamp, drive);
+        module.setParameter(ParameterId::kMix, mix);
+    }
+}
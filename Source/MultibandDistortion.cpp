@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    MultibandDistortion.cpp
+    Created: 23 Oct 2026 11:20:41am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "MultibandDistortion.h"
+#include "ModulePriming.h"
+
+void MultibandDistortion::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    lastSpec = spec;
+    sampleRate = spec.sampleRate;
+
+    for(int i = 0; i < numCrossovers; ++i)
+    {
+        lowpasses[i].prepare(spec);
+        lowpasses[i].setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+        highpasses[i].prepare(spec);
+        highpasses[i].setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+    }
+
+    for(auto& bandAllpasses : allpasses)
+    {
+        for(auto& allpass : bandAllpasses)
+        {
+            allpass.prepare(spec);
+            allpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+        }
+    }
+
+    // can be called again from the audio thread at a new rate, which mustn't reallocate
+    for(auto& band : bands)
+    {
+        band.clipper.prepare(spec);
+        band.saturator.prepare(spec);
+        band.buffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize, false, false, true);
+    }
+
+    const auto previousMode = mode;
+    mode = -1;
+    setMode(previousMode);
+}
+
+void MultibandDistortion::reset()
+{
+    for(int i = 0; i < numCrossovers; ++i)
+    {
+        lowpasses[i].reset();
+        highpasses[i].reset();
+    }
+
+    for(auto& bandAllpasses : allpasses)
+        for(auto& allpass : bandAllpasses)
+            allpass.reset();
+
+    // the viator modules have no reset(), preparing them again is what clears them
+    for(auto& band : bands)
+    {
+        band.clipper.prepare(lastSpec);
+        band.saturator.prepare(lastSpec);
+    }
+}
+
+void MultibandDistortion::resetTo(const Settings& settings)
+{
+    reset();
+
+    for(int i = 0; i < maxBands; ++i)
+    {
+        ModulePriming::prepareAt(bands[i].clipper, lastSpec, settings.drive[i], settings.mix[i]);
+        ModulePriming::prepareAt(bands[i].saturator, lastSpec, settings.drive[i], settings.mix[i]);
+    }
+}
+
+void MultibandDistortion::setMode(int distortionMode)
+{
+    if(distortionMode == mode)
+        return;
+
+    mode = distortionMode;
+
+    for(auto& band : bands)
+    {
+        switch(mode)
+        {
+            case 1: band.clipper.setClipperType(viator_dsp::Clipper<float>::ClipType::kSoft); break;
+            case 2: band.clipper.setClipperType(viator_dsp::Clipper<float>::ClipType::kHard); break;
+            case 3: band.saturator.setDistortionType(viator_dsp::Saturation<float>::DistortionType::kSaturation); break;
+            case 4: band.saturator.setDistortionType(viator_dsp::Saturation<float>::DistortionType::kTape); break;
+            case 5: band.saturator.setDistortionType(viator_dsp::Saturation<float>::DistortionType::kTube); break;
+            case 6: band.clipper.setClipperType(viator_dsp::Clipper<float>::ClipType::kDiode); break;
+            default: break;
+        }
+    }
+}
+
+void MultibandDistortion::updateCrossovers(const Settings& settings)
+{
+    // keep the crossovers in order and at least a third of an octave apart, below nyquist
+    auto minimum = 20.f;
+    const auto maximum = (float)sampleRate * 0.45f;
+
+    for(int i = 0; i < settings.numBands - 1; ++i)
+    {
+        const auto frequency = juce::jlimit(minimum, juce::jmax(minimum, maximum), settings.crossoverFreqs[i]);
+        minimum = frequency * 1.26f;
+
+        lowpasses[i].setCutoffFrequency(frequency);
+        highpasses[i].setCutoffFrequency(frequency);
+
+        for(int band = 0; band < i; ++band)
+            allpasses[band][i].setCutoffFrequency(frequency);
+    }
+}
+
+void MultibandDistortion::process(const juce::dsp::ProcessContextReplacing<float>& context, const Settings& settings, int distortionMode)
+{
+    if(!supportsMode(distortionMode))
+        return;
+
+    setMode(distortionMode);
+
+    const auto numBands = juce::jlimit(2, maxBands, settings.numBands);
+    Settings clamped = settings;
+    clamped.numBands = numBands;
+    updateCrossovers(clamped);
+
+    auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+
+    auto getBandBlock = [&](int band)
+    {
+        return juce::dsp::AudioBlock<float>(bands[band].buffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    };
+
+    // peel the bands off the bottom, whatever is left in the block is the top band
+    for(int i = 0; i < numBands - 1; ++i)
+    {
+        auto bandBlock = getBandBlock(i);
+        bandBlock.copyFrom(block);
+
+        lowpasses[i].process(juce::dsp::ProcessContextReplacing<float>(bandBlock));
+        highpasses[i].process(juce::dsp::ProcessContextReplacing<float>(block));
+
+        // the bands split off earlier need the same phase shift this crossover gives the rest
+        for(int band = 0; band < i; ++band)
+        {
+            auto earlierBlock = getBandBlock(band);
+            allpasses[band][i].process(juce::dsp::ProcessContextReplacing<float>(earlierBlock));
+        }
+    }
+
+    auto distortBand = [&](int band, juce::dsp::AudioBlock<float>& bandBlock)
+    {
+        const juce::dsp::ProcessContextReplacing<float> bandContext(bandBlock);
+        auto& b = bands[band];
+
+        if(mode == 3 || mode == 4 || mode == 5)
+        {
+            b.saturator.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, settings.drive[band]);
+            b.saturator.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix[band]);
+            b.saturator.process(bandContext);
+        }
+        else
+        {
+            b.clipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, settings.drive[band]);
+            b.clipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix[band]);
+            b.clipper.process(bandContext);
+        }
+    };
+
+    std::array<juce::dsp::AudioBlock<float>, maxBands> bandBlocks;
+    for(int i = 0; i < numBands - 1; ++i)
+        bandBlocks[i] = getBandBlock(i);
+    bandBlocks[numBands - 1] = block;
+
+    auto job = [&](int band) { distortBand(band, bandBlocks[band]); };
+
+    if(workerPool != nullptr && workerPool->shouldRunInParallel(numBands, (int)numSamples))
+    {
+        workerPool->parallelFor(numBands, job);
+    }
+    else
+    {
+        for(int band = 0; band < numBands; ++band)
+            job(band);
+    }
+
+    for(int i = 0; i < numBands - 1; ++i)
+        block.add(bandBlocks[i]);
+}
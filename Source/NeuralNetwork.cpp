@@ -23,8 +23,9 @@ NeuralNetwork::NeuralNetwork(std::vector<uint> topology, Scalar learningRate)
       neuronLayers.push_back(new RowVector(topology[i] + 1));
 
     // initialize cache and delta vectors
-    cacheLayers.push_back(new RowVector(neuronLayers.size()));
-    deltas.push_back(new RowVector(neuronLayers.size()));
+    cacheLayers.push_back(new RowVector(neuronLayers.back()->size()));
+    deltas.push_back(new RowVector(neuronLayers.back()->size()));
+    deltas.back()->setZero();
 
     // vector.back() gives the handle to recently added element
     // coeffRef gives the reference of value at that place
@@ -49,3 +50,185 @@ NeuralNetwork::NeuralNetwork(std::vector<uint> topology, Scalar learningRate)
     }
   }
 };
+
+NeuralNetwork::~NeuralNetwork()
+{
+  for (auto* layer : neuronLayers) delete layer;
+  for (auto* layer : cacheLayers) delete layer;
+  for (auto* layer : deltas) delete layer;
+  for (auto* matrix : weights) delete matrix;
+}
+
+Scalar NeuralNetwork::activationFunction(Scalar x)
+{
+  return std::tanh(x);
+}
+
+Scalar NeuralNetwork::activationFunctionDerivative(Scalar x)
+{
+  const Scalar t = std::tanh(x);
+  return 1 - t * t;
+}
+
+void NeuralNetwork::propagateForward(RowVector& input)
+{
+  // set the input to the input layer, leaving the bias neuron alone
+  neuronLayers.front()->block(0, 0, 1, neuronLayers.front()->size() - 1) = input;
+
+  for (uint i = 1; i < topology.size(); i++) {
+    (*cacheLayers[i]) = (*neuronLayers[i - 1]) * (*weights[i - 1]);
+
+    // hidden layers keep their last neuron as the bias, only the rest get activated
+    const auto numNeurons = topology[i];
+    for (uint j = 0; j < numNeurons; j++)
+      neuronLayers[i]->coeffRef(j) = activationFunction(cacheLayers[i]->coeff(j));
+  }
+}
+
+void NeuralNetwork::calcErrors(RowVector& output)
+{
+  // a network without an output layer has nothing to propagate
+  if (topology.size() < 2)
+    return;
+
+  // error of the output layer, then walk the errors back through the weights. Each layer's error
+  // is scaled by its activation slope before it goes through the weights below it, so deltas hold
+  // the error at each layer's activated output and updateWeights() applies that layer's own slope.
+  (*deltas.back()) = output - (*neuronLayers.back());
+
+  for (size_t i = topology.size() - 2; i > 0; i--) {
+    RowVector gradient = deltas[i + 1]->cwiseProduct(
+        cacheLayers[i + 1]->unaryExpr([](Scalar x) { return activationFunctionDerivative(x); }));
+
+    // a hidden layer's bias neuron is a constant, no error flows back through it
+    if (i + 1 != topology.size() - 1)
+      gradient.coeffRef(topology[i + 1]) = 0;
+
+    (*deltas[i]) = gradient * (weights[i]->transpose());
+  }
+}
+
+void NeuralNetwork::updateWeights()
+{
+  if (topology.size() < 2)
+    return;
+
+  for (uint i = 0; i < topology.size() - 1; i++) {
+    // the bias column of a hidden layer is fixed, the output layer has no bias column
+    const uint numColumns = topology[i + 1];
+
+    for (uint c = 0; c < numColumns; c++) {
+      const Scalar gradient = deltas[i + 1]->coeff(c) * activationFunctionDerivative(cacheLayers[i + 1]->coeff(c));
+      weights[i]->col(c) += learningRate * gradient * neuronLayers[i]->transpose();
+    }
+  }
+}
+
+void NeuralNetwork::propagateBackward(RowVector& output)
+{
+  calcErrors(output);
+  updateWeights();
+}
+
+void NeuralNetwork::train(std::vector<RowVector*> data)
+{
+  const auto numInputs = (Eigen::Index)topology.front();
+  const auto numOutputs = (Eigen::Index)topology.back();
+
+  for (auto* point : data) {
+    if (point == nullptr || point->size() != numInputs + numOutputs)
+      continue;
+
+    RowVector input = point->head(numInputs);
+    RowVector output = point->tail(numOutputs);
+
+    propagateForward(input);
+    propagateBackward(output);
+  }
+}
+
+CompactNetwork::CompactNetwork(const std::vector<uint>& topology, bool shouldActivateOutput)
+  : activateOutput(shouldActivateOutput)
+{
+  auto roundUp = [](size_t n) { return (n + arenaAlignment - 1) / arenaAlignment * arenaAlignment; };
+
+  size_t offset = 0;
+  for (size_t i = 1; i < topology.size(); i++) {
+    Layer layer;
+    layer.inputs = (Eigen::Index)topology[i - 1];
+    layer.outputs = (Eigen::Index)topology[i];
+    layer.weightOffset = offset;
+    offset += roundUp((size_t)(layer.inputs * layer.outputs));
+    layer.biasOffset = offset;
+    offset += roundUp((size_t)layer.outputs);
+    layers.push_back(layer);
+
+    maxLayerSize = std::max({ maxLayerSize, layer.inputs, layer.outputs });
+  }
+
+  arena.assign(offset, Scalar(0));
+}
+
+CompactNetwork::CompactNetwork(const NeuralNetwork& network)
+  : CompactNetwork(network.topology, true)
+{
+  // the training network keeps its bias as an extra input row of each weight matrix
+  for (size_t i = 0; i < layers.size(); i++) {
+    const auto& source = *network.weights[i];
+    weights(i) = source.topLeftCorner(layers[i].inputs, layers[i].outputs).transpose();
+    bias(i) = source.row(layers[i].inputs).head(layers[i].outputs).transpose();
+  }
+}
+
+void CompactNetwork::prepare(Workspace& workspace, Eigen::Index maxBatchSize) const
+{
+  for (auto& buffer : workspace.pingPong)
+    buffer.setZero(maxLayerSize, std::max<Eigen::Index>(1, maxBatchSize));
+}
+
+Eigen::Block<Matrix> CompactNetwork::forward(const Eigen::Ref<const Matrix>& inputs, Workspace& workspace) const
+{
+  const auto batch = inputs.cols();
+  eigen_assert(inputs.rows() == getNumInputs() && batch <= workspace.getMaxBatchSize()
+               && workspace.pingPong[0].rows() >= maxLayerSize);
+
+  auto& pingPong = workspace.pingPong;
+
+  // the first layer reads the caller's inputs directly, after that the buffers take turns
+  for (size_t i = 0; i < layers.size(); i++) {
+    const auto& layer = layers[i];
+    auto out = pingPong[i % 2].topLeftCorner(layer.outputs, batch);
+
+    if (i == 0)
+      out.noalias() = weights(i) * inputs;
+    else
+      out.noalias() = weights(i) * pingPong[(i - 1) % 2].topLeftCorner(layer.inputs, batch);
+
+    out.colwise() += bias(i);
+
+    if (i != layers.size() - 1 || activateOutput)
+      out = out.array().tanh().matrix();
+  }
+
+  return pingPong[(layers.size() - 1) % 2].topLeftCorner(getNumOutputs(), batch);
+}
+
+CompactNetwork::MatrixMap CompactNetwork::weights(size_t layer)
+{
+  return MatrixMap(arena.data() + layers[layer].weightOffset, layers[layer].outputs, layers[layer].inputs);
+}
+
+CompactNetwork::ColVectorMap CompactNetwork::bias(size_t layer)
+{
+  return ColVectorMap(arena.data() + layers[layer].biasOffset, layers[layer].outputs);
+}
+
+CompactNetwork::ConstMatrixMap CompactNetwork::weights(size_t layer) const
+{
+  return ConstMatrixMap(arena.data() + layers[layer].weightOffset, layers[layer].outputs, layers[layer].inputs);
+}
+
+CompactNetwork::ConstColVectorMap CompactNetwork::bias(size_t layer) const
+{
+  return ConstColVectorMap(arena.data() + layers[layer].biasOffset, layers[layer].outputs);
+}
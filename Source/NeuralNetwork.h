@@ -11,7 +11,11 @@
 #pragma once
 
 #include <eigen3/Eigen/Eigen>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <new>
 #include <vector>
 
 // use typedefs for future ease for changing data types like : float to double
@@ -25,6 +29,10 @@ class NeuralNetwork {
 public:
   // constructor
   NeuralNetwork(std::vector<uint> topology, Scalar learningRate = Scalar(0.005));
+  ~NeuralNetwork();
+
+  NeuralNetwork(const NeuralNetwork&) = delete;
+  NeuralNetwork& operator=(const NeuralNetwork&) = delete;
 
   // function for forward propagation of data
   void propagateForward(RowVector& input);
@@ -39,6 +47,7 @@ public:
   void updateWeights();
 
   // function to train the neural network give an array of data points
+  // each data point holds the input values followed by the expected output values
   void train(std::vector<RowVector*> data);
 
   // storage objects for working of neural network
@@ -54,4 +63,200 @@ public:
   std::vector<Matrix*> weights; // the connection weights itself
   std::vector<uint> topology;
   Scalar learningRate;
+
+private:
+  static Scalar activationFunction(Scalar x);
+  static Scalar activationFunctionDerivative(Scalar x);
+};
+
+// multilayer perceptron with layer sizes fixed at compile time: tanh on the two hidden layers and
+// a linear output layer. All storage is fixed-size Eigen matrices so inference never allocates.
+template <int Inputs, int Hidden1, int Hidden2, int Outputs>
+class FixedSizeNetwork {
+public:
+  using InputVector = Eigen::Matrix<Scalar, Inputs, 1>;
+  using OutputVector = Eigen::Matrix<Scalar, Outputs, 1>;
+
+  static constexpr int numInputs = Inputs;
+  static constexpr int numOutputs = Outputs;
+  static constexpr size_t numParameters = (size_t)Hidden1 * (Inputs + 1)
+                                        + (size_t)Hidden2 * (Hidden1 + 1)
+                                        + (size_t)Outputs * (Hidden2 + 1);
+
+  // weight files start with this header, followed by w1, b1, w2, b2, w3, b3 as little endian
+  // floats with each matrix stored column major (Eigen's own layout)
+  struct FileHeader {
+    char magic[4];
+    int32_t inputs, hidden1, hidden2, outputs;
+  };
+
+  FixedSizeNetwork() { setZero(); }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  OutputVector process(const InputVector& input) const noexcept
+  {
+    const Eigen::Matrix<Scalar, Hidden1, 1> h1 = (w1 * input + b1).array().tanh();
+    const Eigen::Matrix<Scalar, Hidden2, 1> h2 = (w2 * h1 + b2).array().tanh();
+    return w3 * h2 + b3;
+  }
+
+  void setZero()
+  {
+    w1.setZero(); b1.setZero();
+    w2.setZero(); b2.setZero();
+    w3.setZero(); b3.setZero();
+  }
+
+  // returns false (leaving the weights untouched) if the data isn't a network of this shape
+  bool loadWeights(const void* data, size_t sizeInBytes)
+  {
+    if (data == nullptr || sizeInBytes != sizeof(FileHeader) + numParameters * sizeof(Scalar))
+      return false;
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, "SNTN", 4) != 0
+        || header.inputs != Inputs || header.hidden1 != Hidden1
+        || header.hidden2 != Hidden2 || header.outputs != Outputs)
+      return false;
+
+    auto* read = static_cast<const char*>(data) + sizeof(FileHeader);
+    auto copyInto = [&read](auto& matrix) {
+      const auto bytes = (size_t)matrix.size() * sizeof(Scalar);
+      std::memcpy(matrix.data(), read, bytes);
+      read += bytes;
+    };
+
+    copyInto(w1); copyInto(b1);
+    copyInto(w2); copyInto(b2);
+    copyInto(w3); copyInto(b3);
+
+    return true;
+  }
+
+  // the inverse of loadWeights
+  std::vector<char> saveWeights() const
+  {
+    std::vector<char> data(sizeof(FileHeader) + numParameters * sizeof(Scalar));
+    const auto header = makeHeader();
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    auto* write = data.data() + sizeof(FileHeader);
+    auto copyFrom = [&write](const auto& matrix) {
+      const auto bytes = (size_t)matrix.size() * sizeof(Scalar);
+      std::memcpy(write, matrix.data(), bytes);
+      write += bytes;
+    };
+
+    copyFrom(w1); copyFrom(b1);
+    copyFrom(w2); copyFrom(b2);
+    copyFrom(w3); copyFrom(b3);
+
+    return data;
+  }
+
+  static FileHeader makeHeader()
+  {
+    FileHeader header { { 'S', 'N', 'T', 'N' }, Inputs, Hidden1, Hidden2, Outputs };
+    return header;
+  }
+
+  Eigen::Matrix<Scalar, Hidden1, Inputs> w1;
+  Eigen::Matrix<Scalar, Hidden1, 1> b1;
+  Eigen::Matrix<Scalar, Hidden2, Hidden1> w2;
+  Eigen::Matrix<Scalar, Hidden2, 1> b2;
+  Eigen::Matrix<Scalar, Outputs, Hidden2> w3;
+  Eigen::Matrix<Scalar, Outputs, 1> b3;
+};
+
+// Puts every allocation on a 64 byte boundary. Eigen::aligned_allocator only goes as far as
+// EIGEN_MAX_ALIGN_BYTES (16 or 32), and aligned operator new isn't there before macOS 10.14, so
+// this over-allocates and keeps the malloc'd pointer just in front of the aligned one.
+template <typename T>
+struct CacheLineAllocator {
+  using value_type = T;
+  static constexpr size_t alignment = 64;
+
+  CacheLineAllocator() = default;
+  template <typename U> CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+  T* allocate(size_t n)
+  {
+    auto* raw = std::malloc(n * sizeof(T) + alignment + sizeof(void*));
+    if (raw == nullptr)
+      throw std::bad_alloc();
+
+    const auto aligned = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<T*>(aligned);
+  }
+
+  void deallocate(T* p, size_t) { std::free(reinterpret_cast<void**>(p)[-1]); }
+
+  template <typename U> bool operator==(const CacheLineAllocator<U>&) const { return true; }
+  template <typename U> bool operator!=(const CacheLineAllocator<U>&) const { return false; }
+};
+
+// Inference-only network for running many inputs at once. Every weight and bias lives in one
+// aligned arena (each layer starting on a cache line) and the activations bounce between two
+// preallocated buffers in a Workspace, so a forward pass is one matrix-matrix product per layer
+// with no allocation and no pointer chasing. forward() only reads the network, so one network
+// can be shared by any number of threads as long as each brings its own Workspace. Hidden layers
+// use tanh, the output layer is linear unless activateOutput is set (the training network
+// applies tanh to its outputs too).
+class CompactNetwork {
+public:
+  using Arena = std::vector<Scalar, CacheLineAllocator<Scalar>>;
+  using MatrixMap = Eigen::Map<Matrix, Eigen::Aligned16>;
+  using ConstMatrixMap = Eigen::Map<const Matrix, Eigen::Aligned16>;
+  using ColVectorMap = Eigen::Map<ColVector, Eigen::Aligned16>;
+  using ConstColVectorMap = Eigen::Map<const ColVector, Eigen::Aligned16>;
+
+  // the activation buffers for one caller's forward passes
+  struct Workspace {
+    Matrix pingPong[2];
+
+    Eigen::Index getMaxBatchSize() const { return pingPong[0].cols(); }
+  };
+
+  CompactNetwork() = default;
+  explicit CompactNetwork(const std::vector<uint>& topology, bool activateOutput = false);
+
+  // copies the weights out of a trained network with the same topology
+  explicit CompactNetwork(const NeuralNetwork& network);
+
+  // sizes a workspace's buffers for this network, call before forward() with any batch up to
+  // maxBatchSize
+  void prepare(Workspace& workspace, Eigen::Index maxBatchSize) const;
+
+  // each column of inputs is one example, the returned block lives in the workspace with one
+  // column of outputs per example and stays valid until its next forward()
+  Eigen::Block<Matrix> forward(const Eigen::Ref<const Matrix>& inputs, Workspace& workspace) const;
+
+  // layer i maps topology[i] values to topology[i + 1]
+  MatrixMap weights(size_t layer);
+  ColVectorMap bias(size_t layer);
+  ConstMatrixMap weights(size_t layer) const;
+  ConstColVectorMap bias(size_t layer) const;
+
+  size_t getNumLayers() const { return layers.size(); }
+  Eigen::Index getNumInputs() const { return layers.empty() ? 0 : layers.front().inputs; }
+  Eigen::Index getNumOutputs() const { return layers.empty() ? 0 : layers.back().outputs; }
+
+private:
+  struct Layer {
+    Eigen::Index inputs, outputs;
+    size_t weightOffset, biasOffset;
+  };
+
+  // 16 floats, so with the arena itself on a 64 byte boundary every layer's weights and biases
+  // start on one too
+  static constexpr size_t arenaAlignment = CacheLineAllocator<Scalar>::alignment / sizeof(Scalar);
+
+  std::vector<Layer> layers;
+  Arena arena;
+  Eigen::Index maxLayerSize = 0;
+  bool activateOutput = false;
 };
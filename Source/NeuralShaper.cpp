@@ -0,0 +1,279 @@
+/*
+  ==============================================================================
+
+    NeuralShaper.cpp
+    Created: 19 Oct 2026 8:26:51pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "NeuralShaper.h"
+
+namespace
+{
+    struct ModelHeader
+    {
+        char magic[4];
+        int32_t hiddenSize, skip;
+    };
+
+    struct CurveHeader
+    {
+        char magic[4];
+        int32_t numCoefficients;
+    };
+
+    // shelf gains and the input range
+    constexpr size_t numCurveSettings = 5;
+    constexpr int maxCurveCoefficients = 64;
+
+    constexpr size_t numModelFloats = 3 * NeuralShaper::hiddenSize               // input weights
+                                    + 3 * NeuralShaper::hiddenSize * NeuralShaper::hiddenSize
+                                    + 3 * NeuralShaper::hiddenSize * 2           // both biases
+                                    + NeuralShaper::hiddenSize + 1;              // output neuron
+}
+
+bool NeuralShaper::Model::loadWeights(const void* data, size_t sizeInBytes)
+{
+    if(data == nullptr || sizeInBytes != sizeof(ModelHeader) + numModelFloats * sizeof(float))
+        return false;
+
+    ModelHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if(std::memcmp(header.magic, "SNGR", 4) != 0 || header.hiddenSize != hiddenSize)
+        return false;
+
+    auto* read = static_cast<const char*>(data) + sizeof(ModelHeader);
+    auto copyInto = [&read](float* dest, size_t count)
+    {
+        std::memcpy(dest, read, count * sizeof(float));
+        read += count * sizeof(float);
+    };
+
+    copyInto(inputWeights.data(), (size_t)inputWeights.size());
+    copyInto(hiddenWeights.data(), (size_t)hiddenWeights.size());
+    copyInto(inputBias.data(), (size_t)inputBias.size());
+    copyInto(hiddenBias.data(), (size_t)hiddenBias.size());
+    copyInto(outputWeights.data(), (size_t)outputWeights.size());
+    copyInto(&outputBias, 1);
+    skip = header.skip != 0;
+
+    return true;
+}
+
+std::vector<char> NeuralShaper::Model::saveWeights() const
+{
+    std::vector<char> data(sizeof(ModelHeader) + numModelFloats * sizeof(float));
+
+    const ModelHeader header { { 'S', 'N', 'G', 'R' }, hiddenSize, skip ? 1 : 0 };
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    auto* write = data.data() + sizeof(ModelHeader);
+    auto copyFrom = [&write](const float* source, size_t count)
+    {
+        std::memcpy(write, source, count * sizeof(float));
+        write += count * sizeof(float);
+    };
+
+    copyFrom(inputWeights.data(), (size_t)inputWeights.size());
+    copyFrom(hiddenWeights.data(), (size_t)hiddenWeights.size());
+    copyFrom(inputBias.data(), (size_t)inputBias.size());
+    copyFrom(hiddenBias.data(), (size_t)hiddenBias.size());
+    copyFrom(outputWeights.data(), (size_t)outputWeights.size());
+    copyFrom(&outputBias, 1);
+
+    return data;
+}
+
+void NeuralShaper::Model::createDefault(Model& model)
+{
+    model.inputWeights.setZero();
+    model.hiddenWeights.setZero();
+    model.inputBias.setZero();
+    model.hiddenBias.setZero();
+
+    // update gate shut, so each unit is just tanh(gain * x) with no memory
+    model.inputBias.segment<hiddenSize>(hiddenSize).setConstant(-20.f);
+
+    for(int i = 0; i < hiddenSize; ++i)
+    {
+        const auto gain = 0.5f * std::pow(1.25f, (float)i);
+        model.inputWeights[2 * hiddenSize + i] = gain;
+
+        // every unit contributes equally to a full scale input
+        model.outputWeights[i] = 1.f / (hiddenSize * std::tanh(gain));
+    }
+
+    model.outputBias = 0.f;
+    model.skip = false;
+}
+
+bool NeuralShaper::Curve::loadWeights(const void* data, size_t sizeInBytes)
+{
+    if(data == nullptr || sizeInBytes < sizeof(CurveHeader))
+        return false;
+
+    CurveHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if(std::memcmp(header.magic, "SNCV", 4) != 0
+       || !isPositiveAndNotGreaterThan(header.numCoefficients, maxCurveCoefficients)
+       || sizeInBytes != sizeof(CurveHeader) + (numCurveSettings + (size_t)header.numCoefficients) * sizeof(float))
+        return false;
+
+    std::vector<float> values(numCurveSettings + (size_t)header.numCoefficients);
+    std::memcpy(values.data(), static_cast<const char*>(data) + sizeof(CurveHeader), values.size() * sizeof(float));
+
+    if(!(values[0] > 0.f))
+        return false;
+
+    inputRange = values[0];
+    preLowGain = values[1];
+    preHighGain = values[2];
+    postLowGain = values[3];
+    postHighGain = values[4];
+    coefficients.assign(values.begin() + numCurveSettings, values.end());
+
+    return true;
+}
+
+std::vector<char> NeuralShaper::Curve::saveWeights() const
+{
+    CurveHeader header { { 'S', 'N', 'C', 'V' }, (int32_t)coefficients.size() };
+
+    std::vector<float> values { inputRange, preLowGain, preHighGain, postLowGain, postHighGain };
+    values.insert(values.end(), coefficients.begin(), coefficients.end());
+
+    std::vector<char> data(sizeof(CurveHeader) + values.size() * sizeof(float));
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(CurveHeader), values.data(), values.size() * sizeof(float));
+
+    return data;
+}
+
+float NeuralShaper::Curve::evaluate(float x) const
+{
+    x = jlimit(-inputRange, inputRange, x);
+
+    // Horner's method
+    float y = 0;
+    for(auto c = coefficients.rbegin(); c != coefficients.rend(); ++c)
+        y = y * x + *c;
+
+    return y;
+}
+
+void NeuralShaper::Curve::configureShelf(Shelf& shelf, bool lowShelf, float gainDecibels)
+{
+    shelf.setParameter(Shelf::ParameterId::kType, lowShelf ? Shelf::FilterType::kLowShelf : Shelf::FilterType::kHighShelf);
+    shelf.setParameter(Shelf::ParameterId::kQType, Shelf::QType::kParametric);
+    shelf.setParameter(Shelf::ParameterId::kQ, shelfQ);
+    shelf.setParameter(Shelf::ParameterId::kCutoff, lowShelf ? lowShelfFreq : highShelfFreq);
+    shelf.setParameter(Shelf::ParameterId::kGain, gainDecibels);
+}
+
+NeuralShaper::NeuralShaper()
+{
+    loadDefaultModel();
+}
+
+void NeuralShaper::loadDefaultModel()
+{
+    int size = 0;
+    auto* data = BinaryData::getNamedResource("neuralShaperModel_bin", size);
+
+    if(data == nullptr || !loadModel(data, (size_t)size))
+    {
+        model = std::make_unique<Model>();
+        Model::createDefault(*model);
+        curve.reset();
+        reset();
+    }
+}
+
+void NeuralShaper::prepare(const dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    states.resize(spec.numChannels);
+
+    for(auto* shelf : { &preLowShelf, &preHighShelf, &postLowShelf, &postHighShelf })
+        shelf->prepare(spec);
+
+    configureCurve();
+
+    gainRamp.resize(spec.maximumBlockSize);
+    mixRamp.resize(spec.maximumBlockSize);
+
+    preamp.reset(spec.sampleRate, 0.02);
+    mix.reset(spec.sampleRate, 0.02);
+
+    reset();
+}
+
+void NeuralShaper::reset()
+{
+    for(auto& state : states)
+        state.setZero();
+
+    // the shelves have no reset of their own, re-preparing zeroes their state
+    for(auto* shelf : { &preLowShelf, &preHighShelf, &postLowShelf, &postHighShelf })
+        shelf->prepare({ sampleRate, (uint32)gainRamp.size(), (uint32)states.size() });
+}
+
+void NeuralShaper::setParameter(ParameterId parameter, float parameterValue)
+{
+    switch(parameter)
+    {
+        case ParameterId::kPreamp:
+            preamp.setTargetValue(parameterValue);
+            break;
+        case ParameterId::kMix:
+            mix.setTargetValue(jmap(parameterValue, 0.f, 100.f, 0.f, 1.f));
+            break;
+        case ParameterId::kBypass:
+            bypassed = parameterValue > 0.5f;
+            break;
+    }
+}
+
+bool NeuralShaper::loadModel(const void* data, size_t sizeInBytes)
+{
+    auto newModel = std::make_unique<Model>();
+    if(newModel->loadWeights(data, sizeInBytes))
+    {
+        model = std::move(newModel);
+        curve.reset();
+        reset();
+        return true;
+    }
+
+    auto newCurve = std::make_unique<Curve>();
+    if(newCurve->loadWeights(data, sizeInBytes))
+    {
+        curve = std::move(newCurve);
+        configureCurve();
+        reset();
+        return true;
+    }
+
+    return false;
+}
+
+void NeuralShaper::configureCurve()
+{
+    if(curve == nullptr)
+        return;
+
+    for(auto* shelf : { &preLowShelf, &preHighShelf, &postLowShelf, &postHighShelf })
+        shelf->setParameter(Curve::Shelf::ParameterId::kSampleRate, (float)sampleRate);
+
+    Curve::configureShelf(preLowShelf, true, curve->preLowGain);
+    Curve::configureShelf(preHighShelf, false, curve->preHighGain);
+    Curve::configureShelf(postLowShelf, true, curve->postLowGain);
+    Curve::configureShelf(postHighShelf, false, curve->postHighGain);
+
+    auto* c = curve.get();
+    curveTable.initialise([c](float x) { return c->evaluate(x); }, -c->inputRange, c->inputRange, Curve::tableSize);
+}
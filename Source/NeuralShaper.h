@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    NeuralShaper.h
+    Created: 19 Oct 2026 8:26:51pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "NeuralNetwork.h"
+
+// Data-driven distortion: a 1 x 16 GRU run on every sample, followed by a single linear output
+// neuron (plus the dry input when the model was trained with a skip connection). The gate layout
+// follows PyTorch's GRU (reset, update, new) so captured amp models can be exported directly.
+// Everything is fixed-size Eigen, so processing never allocates.
+//
+// It can also play back a static capture instead: shelving EQ, a polynomial curve baked into a
+// lookup table, then more shelving EQ. Both kinds of file come out of the CLI's --capture command.
+class NeuralShaper
+{
+public:
+    static constexpr int hiddenSize = 16;
+
+    // measured with the --bench-shaper command, one channel at 48kHz should stay below this
+    // share of a single core
+    static constexpr double cpuBudgetPerChannel = 0.02;
+
+    struct Model
+    {
+        using GateVector = Eigen::Matrix<float, 3 * hiddenSize, 1>;
+        using HiddenVector = Eigen::Matrix<float, hiddenSize, 1>;
+
+        GateVector inputWeights, inputBias, hiddenBias;
+        Eigen::Matrix<float, 3 * hiddenSize, hiddenSize> hiddenWeights;
+        HiddenVector outputWeights;
+        float outputBias {0};
+        bool skip {false};
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        // weight files start with "SNGR", the hidden size and the skip flag as int32s, followed by
+        // inputWeights, hiddenWeights (column major), inputBias, hiddenBias, outputWeights and
+        // outputBias as little endian floats
+        bool loadWeights(const void* data, size_t sizeInBytes);
+        std::vector<char> saveWeights() const;
+
+        // a bank of tanh stages at different gains, what the mode sounds like without a capture
+        static void createDefault(Model& model);
+    };
+
+    // memoryless capture, y = post(curve(pre(x)))
+    struct Curve
+    {
+        static constexpr float lowShelfFreq = 250.f;
+        static constexpr float highShelfFreq = 3000.f;
+        static constexpr float shelfQ = 0.3f;
+        static constexpr int tableSize = 2048;
+
+        // the curve is fitted over +-inputRange and held flat outside it
+        float inputRange {1};
+        float preLowGain {0}, preHighGain {0}, postLowGain {0}, postHighGain {0}; // dB
+        std::vector<float> coefficients; // constant term first
+
+        // "SNCV", the number of coefficients as an int32, then inputRange, the four shelf gains
+        // and the coefficients as little endian floats
+        bool loadWeights(const void* data, size_t sizeInBytes);
+        std::vector<char> saveWeights() const;
+
+        float evaluate(float x) const;
+
+        using Shelf = viator_dsp::SVFilter<float>;
+        static void configureShelf(Shelf& shelf, bool lowShelf, float gainDecibels);
+    };
+
+    using HiddenVector = Model::HiddenVector;
+
+    enum class ParameterId
+    {
+        kPreamp,
+        kMix,
+        kBypass
+    };
+
+    // loads the bundled capture (neuralShaperModel.bin) if there is one, the default model if not
+    NeuralShaper();
+
+    void prepare(const dsp::ProcessSpec& spec);
+    void reset();
+
+    void setParameter(ParameterId parameter, float parameterValue);
+
+    // takes either kind of capture file; not realtime safe so only call it while processing is
+    // suspended. Returns false and keeps the current model if the data isn't a capture.
+    bool loadModel(const void* data, size_t sizeInBytes);
+    const Model& getModel() const { return *model; }
+
+    // back to the bundled capture or the default model, same caveats as loadModel()
+    void loadDefaultModel();
+    bool isPlayingCurve() const { return curve != nullptr; }
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        if(bypassed)
+        {
+            return;
+        }
+
+        auto&& inBlock  = context.getInputBlock();
+        auto&& outBlock = context.getOutputBlock();
+
+        jassert(inBlock.getNumChannels() == outBlock.getNumChannels());
+        jassert(inBlock.getNumSamples() == outBlock.getNumSamples());
+
+        const auto numSamples = (int)inBlock.getNumSamples();
+        const auto numChannels = juce::jmin(inBlock.getNumChannels(), states.size());
+
+        jassert(numSamples <= (int)gainRamp.size());
+
+        // the smoothed values are shared by every channel, so step them once per sample up front
+        for(int i = 0; i < numSamples; ++i)
+        {
+            gainRamp[(size_t)i] = Decibels::decibelsToGain(preamp.getNextValue());
+            mixRamp[(size_t)i] = mix.getNextValue();
+        }
+
+        if(curve != nullptr)
+        {
+            for(size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* input = inBlock.getChannelPointer(channel);
+                auto* output = outBlock.getChannelPointer(channel);
+                const auto ch = (float)channel;
+
+                for(int i = 0; i < numSamples; ++i)
+                {
+                    const auto gain = gainRamp[(size_t)i];
+                    auto x = preHighShelf.processSample(preLowShelf.processSample(input[i] * gain, ch), ch);
+                    x = curveTable.processSample(x);
+                    const auto wet = postHighShelf.processSample(postLowShelf.processSample(x, ch), ch) / gain;
+                    output[i] = (1.f - mixRamp[(size_t)i]) * input[i] + mixRamp[(size_t)i] * wet;
+                }
+            }
+
+            return;
+        }
+
+        for(size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* input = inBlock.getChannelPointer(channel);
+            auto* output = outBlock.getChannelPointer(channel);
+            auto& state = states[channel];
+
+            for(int i = 0; i < numSamples; ++i)
+            {
+                const auto gain = gainRamp[(size_t)i];
+                const auto wet = processSample(input[i] * gain, state) / gain;
+                output[i] = (1.f - mixRamp[(size_t)i]) * input[i] + mixRamp[(size_t)i] * wet;
+            }
+        }
+    }
+
+    // runs one sample through the model, updating that channel's hidden state
+    float processSample(float x, HiddenVector& state) const noexcept
+    {
+        const auto& m = *model;
+
+        const Model::GateVector hidden = m.hiddenWeights * state + m.hiddenBias;
+        const Model::GateVector gates = m.inputWeights * x + m.inputBias;
+
+        // sigmoid(x) = 0.5 * tanh(x / 2) + 0.5 keeps everything on Eigen's vectorised tanh
+        const HiddenVector reset = (0.5f * (gates.head<hiddenSize>() + hidden.head<hiddenSize>())).array().tanh() * 0.5f + 0.5f;
+        const HiddenVector update = (0.5f * (gates.segment<hiddenSize>(hiddenSize) + hidden.segment<hiddenSize>(hiddenSize))).array().tanh() * 0.5f + 0.5f;
+        const HiddenVector candidate = (gates.tail<hiddenSize>().array() + reset.array() * hidden.tail<hiddenSize>().array()).tanh();
+
+        state = candidate + update.cwiseProduct(state - candidate);
+
+        return m.outputWeights.dot(state) + m.outputBias + (m.skip ? x : 0.f);
+    }
+
+private:
+    void configureCurve();
+
+    std::unique_ptr<Model> model;
+
+    std::unique_ptr<Curve> curve;
+    dsp::LookupTableTransform<float> curveTable;
+    Curve::Shelf preLowShelf, preHighShelf, postLowShelf, postHighShelf;
+    double sampleRate {44100.0};
+
+    std::vector<HiddenVector, Eigen::aligned_allocator<HiddenVector>> states;
+    std::vector<float> gainRamp, mixRamp;
+
+    SmoothedValue<float> preamp, mix;
+    bool bypassed {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NeuralShaper)
+};
@@ -242,14 +242,17 @@ void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
     {
         if(leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
         {
-            auto size = tempIncomingBuffer.getNumSamples();
+            // the host's blocks can be bigger than the fft, e.g. 4096 against 2048 once the
+            // governor drops the order, then only the newest samples fit
+            const auto incoming = tempIncomingBuffer.getNumSamples();
+            const auto size = juce::jmin(incoming, monoBuffer.getNumSamples());
             
             juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
                                               monoBuffer.getReadPointer(0, size),
                                               monoBuffer.getNumSamples() - size);
             
             juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, (monoBuffer.getNumSamples() - size)),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
+                                              tempIncomingBuffer.getReadPointer(0, incoming - size),
                                               size);
             
             leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
@@ -312,6 +315,22 @@ void ResponseCurve::parameterValueChanged(int parameterIndex, float newValue)
 
 void ResponseCurve::timerCallback()
 {
+    const auto newQualityLevel = audioProcessor.getQualityGovernor().getLevel();
+    if(newQualityLevel != qualityLevel)
+    {
+        qualityLevel = newQualityLevel;
+        const auto quality = QualityGovernor::getSettings(qualityLevel);
+        
+        leftPathProducer.setOrder(static_cast<FFTOrder>(quality.fftOrder));
+        rightPathProducer.setOrder(static_cast<FFTOrder>(quality.fftOrder));
+        startTimerHz(quality.analyserRateHz);
+        
+        if(onQualityLevelChanged)
+        {
+            onQualityLevelChanged(qualityLevel);
+        }
+    }
+    
     if(shouldShowFFT)
     {
         auto fftBounds = getLocalBounds().toFloat();
@@ -326,14 +345,20 @@ void ResponseCurve::timerCallback()
     {
         auto chainSettings = getChainSettings(audioProcessor.apvts);
         
-        monoChain.setBypassed<ChainPositions::lowCut>(chainSettings.lowCutBypassed);
-        monoChain.setBypassed<ChainPositions::highCut>(chainSettings.highCutBypassed);
-
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+        lowCutBypassed = chainSettings.lowCutBypassed;
+        highCutBypassed = chainSettings.highCutBypassed;
+        
+        // no channels, nothing here ever gets processed; before the processor has been
+        // prepared the filters stay at their default rate
+        if(audioProcessor.getSampleRate() > 0)
+        {
+            const dsp::ProcessSpec spec {audioProcessor.getSampleRate(), 0, 0};
+            lowCutFilter.prepare(spec);
+            highCutFilter.prepare(spec);
+        }
         
-        updateCutFilter(monoChain.get<ChainPositions::lowCut>(), lowCutCoefficients);
-        updateCutFilter(monoChain.get<ChainPositions::highCut>(), highCutCoefficients);
+        lowCutFilter.setParameters(chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+        highCutFilter.setParameters(chainSettings.highCutFreq, chainSettings.highCutSlope);
         
     }
     
@@ -344,10 +369,6 @@ void ResponseCurve::paint(juce::Graphics& g)
 {
     auto bounds = getLocalBounds().reduced(2.5f, 0.f);
     
-    auto& lowcut = monoChain.get<ChainPositions::lowCut>();
-    auto& highcut = monoChain.get<ChainPositions::highCut>();
-    
-    auto sampleRate = audioProcessor.getSampleRate();
     auto w = bounds.getWidth();
     
     std::vector<double> mags;
@@ -359,11 +380,11 @@ void ResponseCurve::paint(juce::Graphics& g)
         double mag = 1.f;
         auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
         
-        if(!monoChain.isBypassed<ChainPositions::lowCut>()){
-            mag *= lowcut.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        if(!lowCutBypassed){
+            mag *= lowCutFilter.getMagnitudeForFrequency(freq);
         }
-        if(!monoChain.isBypassed<ChainPositions::highCut>()){
-            mag *= highcut.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        if(!highCutBypassed){
+            mag *= highCutFilter.getMagnitudeForFrequency(freq);
         }
     
         
@@ -457,12 +478,24 @@ DistortionProjAudioProcessorEditor::DistortionProjAudioProcessorEditor (Distorti
 
     distortionTypeAttachment(audioProcessor.apvts, "distortion mode", distortionType),
 
-onOffBulb(Colours::lawngreen)
+onOffBulb(Colours::lawngreen),
+
+    profilerOverlay(audioProcessor.getStageProfiler()),
+    loadReadout(audioProcessor.getLoadMonitor())
 
 {
     
     resetImage();
     
+    responseCurveComponent.onQualityLevelChanged = [this](int level)
+    {
+        const auto meterRate = QualityGovernor::getSettings(level).meterRateHz;
+        for(auto* meter : { &GainMeterInL, &GainMeterInR, &GainMeterOutL, &GainMeterOutR })
+        {
+            meter->setRefreshRate(meterRate);
+        }
+    };
+    
     
 //        onOffSwitch.setToggleState(true, dontSendNotification);
 //        driveBypass.setToggleState(false, dontSendNotification);
@@ -482,92 +515,21 @@ onOffBulb(Colours::lawngreen)
     
     loadImageButton.onClick = [&]() {
         File imageFile = audioProcessor.loadImageFile();
+        if(!imageFile.existsAsFile())
+        {
+            return;
+        }
+        
         auto newThumbnail = ImageCache::getFromFile(imageFile);
         imageUpload.setImage(newThumbnail);
 
-        std::string imagePath = imageFile.getFullPathName().toStdString();
-        std::vector<float> imageHSVvalues = imageAnalyser.processImage(imagePath);
-        int hueFromImage = imageHSVvalues[0];
-        auto saturationFromImage = jmap(imageHSVvalues[1], 0.f, 255.f, 0.f, 20.f);
-        int valueFromImage = imageHSVvalues[2];
+        auto analysis = analysisCache->getOrAnalyse(imageFile, imageAnalyser);
         
-        std::cout << saturationFromImage;
+        auto description = imageAnalyser.getAnalysisOutputString(analysis.patch, analysis.features);
         
-        switch(hueFromImage)
-        {
-            case 0 ... 15 :
-//                output.append("Saturation\n\n");
-                distortionType.setSelectedId(4);
-
-            break;
-                
-            case 164 ... 179 :
-//                output.append("Saturation\n\n");
-                distortionType.setSelectedId(4);
-
-            break;
-                
-            case 105 ... 132  :
-//                output.append("Hard Clip\n\n");
-                distortionType.setSelectedId(3);
-
-            break;
-                
-            case 133 ... 163 :
-//                output.append("Soft Clip\n\n");
-                distortionType.setSelectedId(2);
-            break;
-                
-            case 46 ... 76 :
-//                output.append("Diode Distortion\n\n");
-                distortionType.setSelectedId(7);
-
-            break;
-                
-            case 16 ... 45 :
-//                output.append("Tape Distortion\n\n");
-                distortionType.setSelectedId(5);
-
-            break;
-                
-            case 77 ... 104 :
-//                output.append("Tube Distortion\n\n");
-                distortionType.setSelectedId(6);
-
-            break;
-        }
-        
-        switch(valueFromImage)
-        {
-            case 0 ... 85 :
-//                output.append("Saturation\n\n");
-                highCutKnob.setValue(400);
-                lowCutKnob.setValue(0);
-                highCutKnob.setDoubleClickReturnValue(true,400);
-                lowCutKnob.setDoubleClickReturnValue(true, 0);
-
-            break;
-                
-            case 86 ... 170  :
-//                output.append("Hard Clip\n\n");
-                highCutKnob.setValue(2000);
-                lowCutKnob.setValue(401);
-                highCutKnob.setDoubleClickReturnValue(true,2000);
-                lowCutKnob.setDoubleClickReturnValue(true, 401);
-            break;
-                
-            case 171 ... 255 :
-//                output.append("Saturation\n\n");
-                highCutKnob.setValue(22000);
-                lowCutKnob.setValue(2001);
-                highCutKnob.setDoubleClickReturnValue(true,22000);
-                lowCutKnob.setDoubleClickReturnValue(true, 2001);
-            break;
-        }
-
-        driveKnob.setValue(saturationFromImage);
-        driveKnob.setDoubleClickReturnValue(true, saturationFromImage);
-        imageAnalysisOutput.setText(imageAnalyser.getAnalysisOutputString(hueFromImage, saturationFromImage, valueFromImage));
+        applyImagePatch(analysis.patch);
+        imageAnalysisOutput.setText(description);
+        storeImageAnalysis(newThumbnail, description);
     };
     
     
@@ -600,6 +562,9 @@ onOffBulb(Colours::lawngreen)
         addAndMakeVisible(buttons);
     }
     
+    addChildComponent(profilerOverlay);
+    addAndMakeVisible(loadReadout);
+    
     driveKnob.labels.add({0.f, "0dB"});
     driveKnob.labels.add({1.f, "20dB"});
     
@@ -623,6 +588,16 @@ onOffBulb(Colours::lawngreen)
     menuPopUp.addItem(1, "Init patch");
 //    menuPopUp.addItem(2, "Save preset");
 //    menuPopUp.addItem(3, "Load preset");
+    menuPopUp.addItem(4, "Load amp capture...");
+    menuPopUp.addItem(7, "Multiband on/off");
+    menuPopUp.addItem(8, "Neural amp on/off");
+    
+    if(StageProfiler::isAvailable())
+    {
+        menuPopUp.addSeparator();
+        menuPopUp.addItem(5, "Show/hide CPU profile");
+        menuPopUp.addItem(6, "Save CPU profile...");
+    }
     
     onOffButton.setLookAndFeel(&lnf);
     driveBypass.setLookAndFeel(&lnf);
@@ -714,9 +689,38 @@ onOffBulb(Colours::lawngreen)
             {
                 audioProcessor.loadPreset();
             }
+            else if(result == 4)
+            {
+                if(audioProcessor.loadCaptureModel())
+                {
+                    audioProcessor.apvts.getParameter("neural amp")->setValueNotifyingHost(1.f);
+                }
+            }
+            else if(result == 5)
+            {
+                profilerOverlay.setVisible(!profilerOverlay.isVisible());
+            }
+            else if(result == 6)
+            {
+                audioProcessor.saveStageProfile();
+            }
+            else if(result == 7)
+            {
+                auto* multiband = audioProcessor.apvts.getParameter("multiband");
+                multiband->setValueNotifyingHost(multiband->getValue() > 0.5f ? 0.f : 1.f);
+            }
+            else if(result == 8)
+            {
+                auto* neuralAmp = audioProcessor.apvts.getParameter("neural amp");
+                neuralAmp->setValueNotifyingHost(neuralAmp->getValue() > 0.5f ? 0.f : 1.f);
+            }
         });
     };
         
+    imageAnalyser.setPatchModel(&patchModel.get());
+    restoreImageAnalysis();
+    audioProcessor.addChangeListener(this);
+        
     setSize (1000, 550);
 }
 
@@ -728,6 +732,7 @@ onOffBulb(Colours::lawngreen)
 
 DistortionProjAudioProcessorEditor::~DistortionProjAudioProcessorEditor()
 {
+    audioProcessor.removeChangeListener(this);
     onOffButton.setLookAndFeel(nullptr);
     driveBypass.setLookAndFeel(nullptr);
     lowCutBypass.setLookAndFeel(nullptr);
@@ -749,6 +754,113 @@ void DistortionProjAudioProcessorEditor::resetImage()
     
 }
 
+void DistortionProjAudioProcessorEditor::applyImagePatch(const ImagePatch& patch)
+{
+    // the patch picks one of the analytic modes, which the neural amp would otherwise override
+    audioProcessor.apvts.getParameter("neural amp")->setValueNotifyingHost(0.f);
+    distortionType.setSelectedId(patch.distortionMode + 1);
+    
+    driveKnob.setValue(patch.drive);
+    mixKnob.setValue(patch.mix);
+    driveKnob.setDoubleClickReturnValue(true, patch.drive);
+    mixKnob.setDoubleClickReturnValue(true, patch.mix);
+    
+    if(audioProcessor.apvts.getRawParameterValue("multiband")->load() > 0.5f)
+    {
+        applyImagePatchToBands(patch);
+        return;
+    }
+    
+    lowCutKnob.setValue(patch.lowCutFreq);
+    highCutKnob.setValue(patch.highCutFreq);
+    lowCutKnob.setDoubleClickReturnValue(true, patch.lowCutFreq);
+    highCutKnob.setDoubleClickReturnValue(true, patch.highCutFreq);
+}
+
+void DistortionProjAudioProcessorEditor::applyImagePatchToBands(const ImagePatch& patch)
+{
+    // The patch's cut filters pick the image's frequency range (up to 400Hz, 400Hz-2kHz or above
+    // 2kHz). With three bands split at the same points, that range gets the drive and the rest
+    // of the spectrum passes through clean instead of being filtered out.
+    auto setParameter = [this](const String& id, float value)
+    {
+        auto* parameter = audioProcessor.apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+    
+    const auto distortedBand = patch.highCutFreq <= 400.f ? 0 : (patch.highCutFreq <= 2000.f ? 1 : 2);
+    
+    setParameter("band count", 3.f);
+    setParameter("crossover1 Freq", 400.f);
+    setParameter("crossover2 Freq", 2000.f);
+    
+    for(int band = 0; band < 3; ++band)
+    {
+        setParameter("band" + String(band + 1) + " drive", band == distortedBand ? patch.drive : 0.f);
+        setParameter("band" + String(band + 1) + " mix", band == distortedBand ? patch.mix : 0.f);
+    }
+    
+    lowCutKnob.setValue(1.f);
+    highCutKnob.setValue(22000.f);
+}
+
+void DistortionProjAudioProcessorEditor::storeImageAnalysis(const Image& image, const String& description)
+{
+    if(image.isNull()){
+        return;
+    }
+    
+    // the session only needs something thumbnail sized, not the original image
+    const int maxThumbnailSize = 256;
+    auto thumbnail = image;
+    auto largestSide = jmax(image.getWidth(), image.getHeight());
+    if(largestSide > maxThumbnailSize)
+    {
+        auto scale = (float)maxThumbnailSize / (float)largestSide;
+        thumbnail = image.rescaled(jmax(1, roundToInt(image.getWidth() * scale)),
+                                   jmax(1, roundToInt(image.getHeight() * scale)),
+                                   Graphics::mediumResamplingQuality);
+    }
+    
+    MemoryOutputStream jpegData;
+    JPEGImageFormat jpeg;
+    jpeg.setQuality(0.8f);
+    if(!jpeg.writeImageToStream(thumbnail, jpegData)){
+        return;
+    }
+    
+    audioProcessor.setImageAnalysis(jpegData.getMemoryBlock(), description);
+}
+
+void DistortionProjAudioProcessorEditor::restoreImageAnalysis()
+{
+    auto analysis = audioProcessor.getImageAnalysis();
+    
+    // a state without an analysis (or an older session) shows the empty upload prompt
+    resetImage();
+    imageAnalysisOutput.setText("Upload an JPEG or PNG image to generate a patch");
+    
+    if(auto* thumbnailData = analysis.getProperty("thumbnail").getBinaryData())
+    {
+        auto thumbnail = ImageFileFormat::loadFrom(thumbnailData->getData(), thumbnailData->getSize());
+        if(!thumbnail.isNull()){
+            imageUpload.setImage(thumbnail);
+        }
+    }
+    
+    if(analysis.hasProperty("description")){
+        imageAnalysisOutput.setText(analysis.getProperty("description").toString());
+    }
+}
+
+void DistortionProjAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    // the host restored a different state while the editor was open
+    if(source == &audioProcessor){
+        restoreImageAnalysis();
+    }
+}
+
 void DistortionProjAudioProcessorEditor::initialisePlugin()
 {
     driveKnob.setValue(0);
@@ -764,7 +876,9 @@ void DistortionProjAudioProcessorEditor::initialisePlugin()
     inputGainKnob.setDoubleClickReturnValue(true, 0);
     outputGainKnob.setDoubleClickReturnValue(true, 0);
     distortionType.setSelectedId(1);
+    audioProcessor.apvts.getParameter("neural amp")->setValueNotifyingHost(0.f);
     resetImage();
+    audioProcessor.clearImageAnalysis();
     imageAnalysisOutput.setText("Upload an JPEG or PNG image to generate a patch");
     for(auto button : getButtons())
     {
@@ -999,6 +1113,7 @@ void DistortionProjAudioProcessorEditor::resized()
     auto thumbnailArea = metersArea.removeFromTop(metersArea.getHeight() * 0.33);
     auto thumbNail = thumbnailArea.reduced(5.f);
     auto meters = metersArea.reduced(5.f);
+    auto loadReadoutArea = meters.removeFromBottom(16);
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.5);
     auto response = responseArea.reduced(5.f);
     auto graphAreaSection = responseArea.reduced(20.f, 15.f);
@@ -1091,6 +1206,8 @@ void DistortionProjAudioProcessorEditor::resized()
     loadImageButton.setBounds(uploadButton.reduced(5.f));
     
     responseCurveComponent.setBounds(graphArea);
+    profilerOverlay.setBounds(graphArea);
+    loadReadout.setBounds(loadReadoutArea);
     
     inputGainLabel.setBounds(meterLabels.removeFromLeft(meterLabels.getWidth() * 0.5));
     outputGainLabel.setBounds(meterLabels);
@@ -15,7 +15,10 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "GainMeter.h"
+#include "ProfilerOverlay.h"
 #include "ImageAnalyser.h"
+#include "ImageAnalysisCache.h"
+#include "ImagePatchModel.h"
 
 struct CustomRotarySlider : juce::Slider
 {
@@ -185,6 +188,13 @@ struct PathProducer
     }
     void process(juce::Rectangle<float> fftBounds, double sampleRate);
     juce::Path getPath() {return leftChannelFFTPath;}
+    
+    void setOrder(FFTOrder newOrder)
+    {
+        leftChannelFFTDataGenerator.changeOrder(newOrder);
+        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        monoBuffer.clear();
+    }
 private:
     SingleChannelSampleFifo<DistortionProjAudioProcessor::BlockType>* leftChannelFifo;
 
@@ -276,11 +286,16 @@ public:
         shouldShowFFT = enabled;
     }
     
+    // called with the new QualityGovernor level when the processor changes it
+    std::function<void(int)> onQualityLevelChanged;
+    
 private:
     DistortionProjAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged {false};
     
-    MonoChain monoChain;
+    // copies of the processor's cut filters, only used for their response
+    CutFilter lowCutFilter {CutFilter::highpass}, highCutFilter {CutFilter::lowpass};
+    bool lowCutBypassed {false}, highCutBypassed {false};
     
     juce::Rectangle<int> getAnalysisArea();
     juce::Rectangle<int> getRenderArea();
@@ -288,13 +303,15 @@ private:
     PathProducer leftPathProducer, rightPathProducer;
     
     bool shouldShowFFT = true;
+    int qualityLevel = QualityGovernor::full;
     
 };
 
 
 //==============================================================================
 
-class DistortionProjAudioProcessorEditor  : public juce::AudioProcessorEditor
+class DistortionProjAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                            private juce::ChangeListener
 {
 public:
     DistortionProjAudioProcessorEditor (DistortionProjAudioProcessor&);
@@ -305,6 +322,11 @@ public:
     void resized() override;
     void resetImage();
     void initialisePlugin();
+    void applyImagePatch(const ImagePatch& patch);
+    void applyImagePatchToBands(const ImagePatch& patch);
+    void storeImageAnalysis(const Image& image, const String& description);
+    void restoreImageAnalysis();
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
 //    void createLabel(String string, Label label);
 
@@ -331,6 +353,9 @@ private:
     
     Gui::Bulb onOffBulb;
     
+    Gui::ProfilerOverlay profilerOverlay;
+    Gui::LoadReadout loadReadout;
+    
     RotarySliderWithLabels driveKnob,
     highCutKnob,
     lowCutKnob,
@@ -380,6 +405,8 @@ private:
     CustomLookAndFeel lnf;
     
     ImageAnalyser imageAnalyser;
+    juce::SharedResourcePointer<ImageAnalysisCache> analysisCache;
+    juce::SharedResourcePointer<ImagePatchModel> patchModel;
     
     PopupMenu menuPopUp;
     
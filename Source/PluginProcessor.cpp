@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ModulePriming.h"
 #include "math.h"
 
 //==============================================================================
@@ -45,6 +46,8 @@ DistortionProjAudioProcessor::DistortionProjAudioProcessor()
 //
 //    distortionTypeParam = dynamic_cast<AudioParameterChoice*>(apvts.getParameter("distortion mode"));
 //    jassert(distortionTypeParam != nullptr);
+    
+    tailLengthSeconds = calculateTailLengthSeconds(getChainSettings(apvts));
 
 }
 
@@ -87,7 +90,28 @@ bool DistortionProjAudioProcessor::isMidiEffect() const
 
 double DistortionProjAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
+}
+
+double DistortionProjAudioProcessor::calculateTailLengthSeconds(const ChainSettings& settings)
+{
+    // Whatever rings longest of the cut filters, the tape filter (first order, so it falls by e
+    // every 1 / (2 pi f) seconds and takes ln(10^6) of those to reach -120dB) and the lowest
+    // crossover. On top of that the gain ramps and the distortion's smoothers and GRU state,
+    // all well under 100ms.
+    const auto decayTime = [](double frequency) { return std::log(1.0e6) / (MathConstants<double>::twoPi * frequency); };
+    
+    auto lowestCutoff = 130.0; // the tape filter
+    if(settings.multiband)
+        lowestCutoff = jmin(lowestCutoff, (double)settings.bands.crossoverFreqs[0]);
+    
+    auto tail = decayTime(jmax(1.0, lowestCutoff));
+    if(!settings.lowCutBypassed)
+        tail = jmax(tail, CutFilter::getDecayTimeSeconds(settings.lowCutFreq, settings.lowCutSlope));
+    if(!settings.highCutBypassed)
+        tail = jmax(tail, CutFilter::getDecayTimeSeconds(settings.highCutFreq, settings.highCutSlope));
+    
+    return tail + 0.1;
 }
 
 int DistortionProjAudioProcessor::getNumPrograms()
@@ -131,36 +155,164 @@ void DistortionProjAudioProcessor::prepareToPlay (double sampleRate, int samples
     inputGain.prepare(spec);
     inputGain.setRampDurationSeconds(0.05);
     
-    softClipper.prepare(spec);
-    softClipper.setClipperType(Clipper::ClipType::kSoft);
+    for(auto& modules : distortionModules)
+    {
+        modules.softClipper.setClipperType(Clipper::ClipType::kSoft);
+        modules.hardClipper.setClipperType(Clipper::ClipType::kHard);
+        modules.diodeDistortion.setClipperType(Clipper::ClipType::kDiode);
+        modules.saturation.setDistortionType(Saturator::DistortionType::kSaturation);
+        modules.tubeDistortion.setDistortionType(Saturator::DistortionType::kTube);
+        modules.tapeDistortion.setDistortionType(Saturator::DistortionType::kTape);
+    }
     
-    hardClipper.prepare(spec);
-    hardClipper.setClipperType(Clipper::ClipType::kHard);
+    neuralShaper.prepare(spec);
     
-    diodeDistortion.prepare(spec);
-    diodeDistortion.setClipperType(Clipper::ClipType::kDiode);
+    dynamicDrive.prepare(spec);
+    emphasisEQ.prepare(spec);
     
-    saturation.prepare(spec);
-    saturation.setDistortionType(Saturator::DistortionType::kSaturation);
+    loadMonitor.reset(sampleRate, samplesPerBlock);
+    qualityGovernor.prepare(sampleRate);
     
-    tubeDistortion.prepare(spec);
-    tubeDistortion.setDistortionType(Saturator::DistortionType::kTube);
+    // linear phase with a whole number of samples latency, so the orders can be lined up with
+    // plain delays
+    for(int order = 1; order < numOversamplingOrders; ++order)
+    {
+        oversamplers[order] = std::make_unique<dsp::Oversampling<float>>(spec.numChannels, order,
+                                                                         dsp::Oversampling<float>::filterHalfBandFIREquiripple,
+                                                                         true, true);
+        oversamplers[order]->initProcessing(samplesPerBlock);
+        oversamplerLatency[order] = roundToInt(oversamplers[order]->getLatencyInSamples());
+    }
     
-    tapeDistortion.prepare(spec);
-    tapeDistortion.setDistortionType(Saturator::DistortionType::kTape);
+    const auto maxDistortionLatency = *std::max_element(oversamplerLatency.begin(), oversamplerLatency.end());
+    for(auto& delay : alignmentDelays)
+    {
+        delay.prepare(spec);
+        delay.setMaximumDelayInSamples(maxDistortionLatency);
+    }
+    
+    // one worker per band besides the audio thread's own, leaving a core for the host
+    const auto numWorkers = jmin(MultibandDistortion::maxBands - 1, SystemStats::getNumCpus() - 2);
+    if(workerPool == nullptr && numWorkers > 0){
+        workerPool = std::make_unique<RealtimeWorkerPool>(numWorkers);
+    }
+    
+    baseSpec = spec;
+    
+    for(int order = 0; order < numOversamplingOrders; ++order)
+    {
+        prepareDistortion(order);
+    }
+    
+    // start in whatever state the parameters are already in, without fading into it
+    const auto chainSettings = getChainSettings(apvts);
+    tailLengthSeconds = calculateTailLengthSeconds(chainSettings);
+    
+    const auto qualityLevel = isNonRealtime() ? (int)QualityGovernor::full : qualityGovernor.getLevel();
+    oversamplingOrder = getOversamplingOrder(chainSettings, qualityLevel);
+    switchBuffer.setSize(spec.numChannels, samplesPerBlock);
+    
+    silenceDetector.reset();
+    
+    // offline renders trim this much from the start, so it has to be right before the first block
+    reportedLatency = calculateLatencySamples(chainSettings);
+    setLatencySamples(reportedLatency);
+    
+    // the powered off and bypassed drive paths are delayed to match the distortion stage
+    bypasses.prepare(sampleRate, samplesPerBlock, spec.numChannels, maxDistortionLatency);
+    bypasses.setLatency(BypassManager::power, getDistortionLatency(chainSettings));
+    bypasses.setLatency(BypassManager::drive, getDistortionLatency(chainSettings));
+    bypasses.setBypassed(BypassManager::power, !chainSettings.powerSwitch, true);
+    bypasses.setBypassed(BypassManager::inputGain, chainSettings.inputgainBypassed, true);
+    bypasses.setBypassed(BypassManager::drive, chainSettings.driveBypassed, true);
+    bypasses.setBypassed(BypassManager::lowCut, chainSettings.lowCutBypassed, true);
+    bypasses.setBypassed(BypassManager::highCut, chainSettings.highCutBypassed, true);
+    bypasses.setBypassed(BypassManager::outputGain, chainSettings.outputgainBypassed, true);
     
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    lowCutFilter.prepare(spec);
+    highCutFilter.prepare(spec);
     
-    updateFilters();
+    updateFilters(chainSettings);
     
 //    mixControl.prepare(spec);
 
 }
 
+int DistortionProjAudioProcessor::getOversamplingOrder(const ChainSettings& settings, int qualityLevel)
+{
+    return jlimit(0, QualityGovernor::getSettings(qualityLevel).oversamplingOrder, settings.oversampling);
+}
+
+int DistortionProjAudioProcessor::calculateLatencySamples(const ChainSettings& settings) const
+{
+    return dynamicDrive.calculateLookaheadSamples(settings.dynamics) + getDistortionLatency(settings);
+}
+
+dsp::ProcessSpec DistortionProjAudioProcessor::getDistortionSpec(int order) const
+{
+    auto spec = baseSpec;
+    const auto factor = 1u << order;
+    spec.sampleRate *= factor;
+    spec.maximumBlockSize *= factor;
+    return spec;
+}
+
+void DistortionProjAudioProcessor::prepareDistortion(int order)
+{
+    // also called from the audio thread to reset a set once it's been faded out; the modules
+    // only reset their smoothers and filter state here, which doesn't allocate once prepared
+    const auto spec = getDistortionSpec(order);
+    auto& modules = distortionModules[order];
+    
+    modules.softClipper.prepare(spec);
+    modules.hardClipper.prepare(spec);
+    modules.diodeDistortion.prepare(spec);
+    modules.saturation.prepare(spec);
+    modules.tubeDistortion.prepare(spec);
+    modules.tapeDistortion.prepare(spec);
+    modules.multiband.prepare(spec);
+    
+    if(auto* oversampler = oversamplers[order].get()){
+        oversampler->reset();
+    }
+    
+    alignmentDelays[order].reset();
+}
+
+void DistortionProjAudioProcessor::primeDistortion(int order, const ChainSettings& settings)
+{
+    // the set has sat idle since it was last used, so its filters are cleared and its smoothers
+    // put straight onto the current drive and mix
+    const auto spec = getDistortionSpec(order);
+    auto& modules = distortionModules[order];
+    
+    for(auto* clipper : { &modules.softClipper, &modules.hardClipper, &modules.diodeDistortion }){
+        ModulePriming::prepareAt(*clipper, spec, settings.drive, settings.mix);
+    }
+    
+    for(auto* saturator : { &modules.saturation, &modules.tubeDistortion, &modules.tapeDistortion }){
+        ModulePriming::prepareAt(*saturator, spec, settings.drive, settings.mix);
+    }
+    
+    modules.multiband.resetTo(settings.bands);
+    
+    if(auto* oversampler = oversamplers[order].get()){
+        oversampler->reset();
+    }
+    
+    alignmentDelays[order].reset();
+}
+
+void DistortionProjAudioProcessor::handleAsyncUpdate()
+{
+    // the lookahead or oversampling changed on the audio thread, hosts want to hear about it
+    // from this one
+    setLatencySamples(reportedLatency.load());
+}
+
 void DistortionProjAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
@@ -196,6 +348,9 @@ bool DistortionProjAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
 void DistortionProjAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    RealtimeSafety::ScopedAudioThread audioThread;
+    const HostLoadMonitor::ScopedTimer loadTimer(loadMonitor, buffer.getNumSamples());
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -210,89 +365,259 @@ void DistortionProjAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
     
     auto settings = getChainSettings(apvts);
     
-    if(settings.powerSwitch==true){
+    // before the power switch, so the lookahead latency is the same whether it's on or off
+    dynamicDrive.process(buffer, settings.dynamics);
+    
+    bypasses.setBypassed(BypassManager::power, !settings.powerSwitch);
+    bypasses.setLatency(BypassManager::power, getDistortionLatency(settings));
+    
+    bypasses.process(BypassManager::power, buffer,
+                     [&] { processChain(buffer, settings); },
+                     [this] { resetChainState(); });
+    
+    const auto latency = calculateLatencySamples(settings);
+    if(latency != reportedLatency.load()){
+        reportedLatency = latency;
+        triggerAsyncUpdate();
+    }
+}
+
+void DistortionProjAudioProcessor::processChain(juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+{
+    tailLengthSeconds.store(calculateTailLengthSeconds(settings), std::memory_order_relaxed);
+    
+    // nothing in and nothing left ringing, skip everything including the analyser; the input is
+    // judged as if it had been through the gains and the drive's full 20dB
+    auto chainGainDb = 0.f;
+    if(!settings.inputgainBypassed)
+        chainGainDb += settings.inputgain;
+    if(!settings.driveBypassed && settings.distortionMode != 0)
+        chainGainDb += 20.f;
+    if(!settings.outputgainBypassed)
+        chainGainDb += settings.outputgain;
+    
+    if(silenceDetector.shouldSkip(buffer, Decibels::decibelsToGain(chainGainDb, -300.f))){
+        buffer.clear();
+        rmsInLevelLeft = rmsInLevelRight = rmsOutLevelLeft = rmsOutLevelRight = Decibels::gainToDecibels(0.f);
+        return;
+    }
+
+    auto block = dsp::AudioBlock<float>(buffer);
+    
+    inputGain.setGainDecibels(settings.inputgain);
+    outputGain.setGainDecibels(settings.outputgain);
+    
+    bypasses.setBypassed(BypassManager::inputGain, settings.inputgainBypassed);
+    bypasses.setBypassed(BypassManager::drive, settings.driveBypassed);
+    bypasses.setLatency(BypassManager::drive, getDistortionLatency(settings));
+    bypasses.setBypassed(BypassManager::lowCut, settings.lowCutBypassed);
+    bypasses.setBypassed(BypassManager::highCut, settings.highCutBypassed);
+    bypasses.setBypassed(BypassManager::outputGain, settings.outputgainBypassed);
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::inputGain);
+        bypasses.process(BypassManager::inputGain, buffer,
+                         [&] { applyGain(buffer, inputGain); },
+                         [this] { inputGain.reset(); });
+    }
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::inputMetering);
+        rmsInLevelLeft = Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, buffer.getNumSamples()));
+        rmsInLevelRight = Decibels::gainToDecibels(buffer.getRMSLevel(1, 0, buffer.getNumSamples()));
+    }
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::distortion);
+        
+        qualityGovernor.update(loadMonitor.getLastLoad(), buffer.getNumSamples(), isNonRealtime());
+        const auto order = getOversamplingOrder(settings, qualityGovernor.getLevel());
+        
+        bypasses.process(BypassManager::drive, buffer, [&] {
+            // with no distortion the pre and post EQ would only cancel out
+            const auto useEmphasis = settings.distortionMode != 0;
+            if(useEmphasis){
+                emphasisEQ.setParameters(settings.emphasis, settings.emphasisFreq);
+                emphasisEQ.processPre(block);
+            }
+            
+            // A new order comes in over one block while the old one plays out, each through its
+            // own oversampler and modules, rather than re-preparing what's playing and ramping
+            // through dry. The modes that don't oversample just carry on.
+            const auto crossfade = order != oversamplingOrder && isOversampledMode(settings.distortionMode);
+            if(order != oversamplingOrder){
+                primeDistortion(order, settings);
+            }
+            
+            const auto numSamples = (int)block.getNumSamples();
+            if(crossfade){
+                for(int channel = 0; channel < (int)block.getNumChannels(); ++channel){
+                    switchBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+                }
+                
+                auto switchBlock = dsp::AudioBlock<float>(switchBuffer).getSubsetChannelBlock(0, block.getNumChannels()).getSubBlock(0, (size_t)numSamples);
+                processDistortionStage(switchBlock, settings, oversamplingOrder);
+            }
+            
+            processDistortionStage(block, settings, order);
+            
+            if(crossfade){
+                for(int channel = 0; channel < (int)block.getNumChannels(); ++channel){
+                    buffer.applyGainRamp(channel, 0, numSamples, 0.f, 1.f);
+                    buffer.addFromWithRamp(channel, 0, switchBuffer.getReadPointer(channel), numSamples, 1.f, 0.f);
+                }
+            }
+            
+            oversamplingOrder = order;
+            
+            if(useEmphasis){
+                emphasisEQ.processPost(block);
+            }
+        }, [this] {
+            prepareDistortion(oversamplingOrder);
+            neuralShaper.reset();
+            emphasisEQ.reset();
+        });
+    }
     
-        auto block = dsp::AudioBlock<float>(buffer);
-        auto context = dsp::ProcessContextReplacing<float>(block);
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::cutFilters);
+        
+        updateFilters(settings);
         
-        inputGain.setGainDecibels(settings.inputgain);
-        outputGain.setGainDecibels(settings.outputgain);
+        bypasses.process(BypassManager::lowCut, buffer,
+                         [&] { lowCutFilter.process(block); },
+                         [this] { lowCutFilter.reset(); });
         
-        if(settings.inputgainBypassed==false){
-            applyGain(buffer, inputGain);
+        bypasses.process(BypassManager::highCut, buffer,
+                         [&] { highCutFilter.process(block); },
+                         [this] { highCutFilter.reset(); });
+    }
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::outputGain);
+        bypasses.process(BypassManager::outputGain, buffer,
+                         [&] { applyGain(buffer, outputGain); },
+                         [this] { outputGain.reset(); });
+    }
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::outputMetering);
+        rmsOutLevelLeft = Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, buffer.getNumSamples()));
+        rmsOutLevelRight = Decibels::gainToDecibels(buffer.getRMSLevel(1, 0, buffer.getNumSamples()));
+    }
+    
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::analyserFifo);
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+    }
+    
+    silenceDetector.processed(buffer, (int)std::ceil(tailLengthSeconds.load(std::memory_order_relaxed) * getSampleRate()));
+}
+
+void DistortionProjAudioProcessor::processDistortionStage(dsp::AudioBlock<float> block, const ChainSettings& settings, int order)
+{
+    auto& modules = distortionModules[order];
+    auto* oversampler = isOversampledMode(settings.distortionMode) ? oversamplers[order].get() : nullptr;
+    auto distortionBlock = oversampler != nullptr ? oversampler->processSamplesUp(block) : block;
+    auto distortionContext = dsp::ProcessContextReplacing<float>(distortionBlock);
+    
+    if(settings.dynamics.amount == 0.f){
+        processDistortion(modules, distortionContext, settings, 0.f);
+    }
+    else{
+        // the drive follows the envelope a chunk at a time, at whatever rate the distortion runs
+        const auto factor = distortionBlock.getNumSamples() / block.getNumSamples();
+        for(int chunk = 0; chunk < dynamicDrive.getNumChunks(); ++chunk){
+            const auto start = (size_t)(chunk * DynamicDrive::chunkSize) * factor;
+            const auto length = jmin((size_t)DynamicDrive::chunkSize * factor, distortionBlock.getNumSamples() - start);
+            auto chunkBlock = distortionBlock.getSubBlock(start, length);
+            processDistortion(modules, dsp::ProcessContextReplacing<float>(chunkBlock), settings, dynamicDrive.getDriveOffset(chunk));
+        }
+    }
+    
+    if(oversampler != nullptr){
+        oversampler->processSamplesDown(block);
+    }
+    
+    // make up the rest of the latency this "oversampling" setting reports. An order that's
+    // fading out after the setting was lowered can be longer than that for its last block.
+    const auto pathLatency = oversampler != nullptr ? oversamplerLatency[(size_t)order] : 0;
+    auto& alignment = alignmentDelays[(size_t)order];
+    alignment.setDelay((float)jmax(0, getDistortionLatency(settings) - pathLatency));
+    alignment.process(dsp::ProcessContextReplacing<float>(block));
+}
+
+void DistortionProjAudioProcessor::processDistortion(DistortionModules& modules, const dsp::ProcessContextReplacing<float>& context, const ChainSettings& settings, float driveOffset)
+{
+    const auto drive = jlimit(0.f, 20.f, settings.drive + driveOffset);
+    
+    if(settings.multiband && MultibandDistortion::supportsMode(settings.distortionMode)){
+        auto bands = settings.bands;
+        for(auto& bandDrive : bands.drive){
+            bandDrive = jlimit(0.f, 20.f, bandDrive + driveOffset);
         }
         
-        rmsInLevelLeft = Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, buffer.getNumSamples()));
-        rmsInLevelRight = Decibels::gainToDecibels(buffer.getRMSLevel(1, 0, buffer.getNumSamples()));
-                    
+        modules.multiband.setWorkerPool(settings.parallelBands ? workerPool.get() : nullptr);
+        modules.multiband.process(context, bands, settings.distortionMode);
+    }
+    else{
         switch(settings.distortionMode){
             case 0:
                 break;
             case 1:
-                softClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, settings.drive);
-                softClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
-                softClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kBypass, settings.driveBypassed);
-                softClipper.process(context);
+                modules.softClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, drive);
+                modules.softClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
+                modules.softClipper.process(context);
                 break;
             case 2:
-                hardClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, settings.drive);
-                hardClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
-                hardClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kBypass, settings.driveBypassed);
-                hardClipper.process(context);
+                modules.hardClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, drive);
+                modules.hardClipper.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
+                modules.hardClipper.process(context);
                 break;
             case 3:
-                saturation.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, settings.drive);
-                saturation.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
-                saturation.setParameter(viator_dsp::Saturation<float>::ParameterId::kBypass, settings.driveBypassed);
-                saturation.process(context);
+                modules.saturation.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, drive);
+                modules.saturation.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
+                modules.saturation.process(context);
                 break;
             case 4:
-                tapeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, settings.drive);
-                tapeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
-                tapeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kBypass, settings.driveBypassed);
-                tapeDistortion.process(context);
+                modules.tapeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, drive);
+                modules.tapeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
+                modules.tapeDistortion.process(context);
                 break;
             case 5:
-                tubeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, settings.drive);
-                tubeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
-                tubeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kBypass, settings.driveBypassed);
-                tubeDistortion.process(context);
+                modules.tubeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kPreamp, drive);
+                modules.tubeDistortion.setParameter(viator_dsp::Saturation<float>::ParameterId::kMix, settings.mix);
+                modules.tubeDistortion.process(context);
                 break;
             case 6:
-                diodeDistortion.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, settings.drive);
-                diodeDistortion.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
-                diodeDistortion.setParameter(viator_dsp::Clipper<float>::ParameterId::kBypass, settings.driveBypassed);
-                diodeDistortion.process(context);
+                modules.diodeDistortion.setParameter(viator_dsp::Clipper<float>::ParameterId::kPreamp, drive);
+                modules.diodeDistortion.setParameter(viator_dsp::Clipper<float>::ParameterId::kMix, settings.mix);
+                modules.diodeDistortion.process(context);
+                break;
+            case ChainSettings::neuralAmpMode:
+                neuralShaper.setParameter(NeuralShaper::ParameterId::kPreamp, drive);
+                neuralShaper.setParameter(NeuralShaper::ParameterId::kMix, settings.mix);
+                neuralShaper.process(context);
+                break;
             default:
                 break;
         }
-        
-        updateFilters();
-
-        auto leftBlock = block.getSingleChannelBlock(0);
-        auto rightBlock = block.getSingleChannelBlock(1);
-        
-        dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-        dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-        
-        leftChain.process(leftContext);
-        rightChain.process(rightContext);
-        
-        if(settings.outputgainBypassed==false){
-            applyGain(buffer, outputGain);
-        }
-        
-        rmsOutLevelLeft = Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, buffer.getNumSamples()));
-        rmsOutLevelRight = Decibels::gainToDecibels(buffer.getRMSLevel(1, 0, buffer.getNumSamples()));
-        
-        leftChannelFifo.update(buffer);
-        rightChannelFifo.update(buffer);
-    
     }
-
-    
 }
 
+void DistortionProjAudioProcessor::resetChainState()
+{
+    inputGain.reset();
+    outputGain.reset();
+    prepareDistortion(oversamplingOrder);
+    neuralShaper.reset();
+    emphasisEQ.reset();
+    lowCutFilter.reset();
+    highCutFilter.reset();
+    silenceDetector.reset();
+}
 
 //==============================================================================
 bool DistortionProjAudioProcessor::hasEditor() const
@@ -315,7 +640,23 @@ void DistortionProjAudioProcessor::getStateInformation (juce::MemoryBlock& destD
     // as intermediaries to make it easy to save and load complex data.
     
     MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    auto state = apvts.copyState();
+    
+    {
+        const RealtimeSafety::CriticalSection::ScopedLockType sl(imageAnalysisLock);
+        if(imageAnalysis.getNumProperties() > 0){
+            state.appendChild(imageAnalysis.createCopy(), nullptr);
+        }
+    }
+    
+    {
+        const RealtimeSafety::CriticalSection::ScopedLockType sl(captureModelLock);
+        if(captureModel.getNumProperties() > 0){
+            state.appendChild(captureModel.createCopy(), nullptr);
+        }
+    }
+    
+    state.writeToStream(mos);
 }
 
 void DistortionProjAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -325,71 +666,153 @@ void DistortionProjAudioProcessor::setStateInformation (const void* data, int si
     
     auto tree = ValueTree::readFromData(data, sizeInBytes);
     if(tree.isValid()){
+        auto savedAnalysis = tree.getChildWithName("ImageAnalysis");
+        tree.removeChild(savedAnalysis, nullptr);
+        
+        {
+            const RealtimeSafety::CriticalSection::ScopedLockType sl(imageAnalysisLock);
+            imageAnalysis = savedAnalysis.isValid() ? savedAnalysis : ValueTree("ImageAnalysis");
+        }
+        sendChangeMessage();
+        
+        auto savedCapture = tree.getChildWithName("CaptureModel");
+        tree.removeChild(savedCapture, nullptr);
+        
+        if(auto* modelData = savedCapture.getProperty("data").getBinaryData()){
+            setCaptureModel(*modelData);
+        }
+        else{
+            suspendProcessing(true);
+            neuralShaper.loadDefaultModel();
+            suspendProcessing(false);
+            
+            const RealtimeSafety::CriticalSection::ScopedLockType sl(captureModelLock);
+            captureModel = ValueTree("CaptureModel");
+        }
+        
         apvts.replaceState(tree);
     }
 }
 
+void DistortionProjAudioProcessor::setImageAnalysis(const MemoryBlock& thumbnailJpeg, const String& description)
+{
+    ValueTree analysis {"ImageAnalysis"};
+    analysis.setProperty("thumbnail", var(thumbnailJpeg), nullptr);
+    analysis.setProperty("description", description, nullptr);
+    
+    const RealtimeSafety::CriticalSection::ScopedLockType sl(imageAnalysisLock);
+    imageAnalysis = analysis;
+}
+
+void DistortionProjAudioProcessor::clearImageAnalysis()
+{
+    const RealtimeSafety::CriticalSection::ScopedLockType sl(imageAnalysisLock);
+    imageAnalysis = ValueTree("ImageAnalysis");
+}
+
+ValueTree DistortionProjAudioProcessor::getImageAnalysis() const
+{
+    const RealtimeSafety::CriticalSection::ScopedLockType sl(imageAnalysisLock);
+    return imageAnalysis.createCopy();
+}
+
+bool DistortionProjAudioProcessor::setCaptureModel(const MemoryBlock& modelData)
+{
+    // the shaper swaps its model outside the audio callback
+    suspendProcessing(true);
+    auto loaded = neuralShaper.loadModel(modelData.getData(), modelData.getSize());
+    suspendProcessing(false);
+    
+    if(loaded){
+        const RealtimeSafety::CriticalSection::ScopedLockType sl(captureModelLock);
+        captureModel = ValueTree("CaptureModel");
+        captureModel.setProperty("data", var(modelData), nullptr);
+    }
+    
+    return loaded;
+}
+
+bool DistortionProjAudioProcessor::saveStageProfile() const
+{
+    FileChooser chooser {"Save the CPU profile", File::getSpecialLocation(File::userDesktopDirectory).getChildFile("Sentifier profile.csv"), "*.csv"};
+    
+    if(chooser.browseForFileToSave(true)){
+        return stageProfiler.writeReport(chooser.getResult());
+    }
+    
+    return false;
+}
+
+bool DistortionProjAudioProcessor::loadCaptureModel()
+{
+    FileChooser chooser {"Select an amp capture", File(), "*.bin"};
+    MemoryBlock modelData;
+    
+    if(chooser.browseForFileToOpen() && chooser.getResult().loadFileAsData(modelData)){
+        return setCaptureModel(modelData);
+    }
+    
+    return false;
+}
+
+// literals rather than built strings, getChainSettings() runs on the audio thread
+static const char* const crossoverFreqIds[] = { "crossover1 Freq", "crossover2 Freq", "crossover3 Freq", "crossover4 Freq" };
+static const char* const bandDriveIds[] = { "band1 drive", "band2 drive", "band3 drive", "band4 drive", "band5 drive" };
+static const char* const bandMixIds[] = { "band1 mix", "band2 mix", "band3 mix", "band4 mix", "band5 mix" };
+
 ChainSettings getChainSettings(AudioProcessorValueTreeState& apvts)
 {
     ChainSettings settings;
     
     settings.highCutFreq = apvts.getRawParameterValue("highCut Freq")->load();
     settings.lowCutFreq = apvts.getRawParameterValue("lowCut Freq")->load();
+    settings.highCutSlope = static_cast<CutFilter::Slope>(apvts.getRawParameterValue("highCut Slope")->load());
+    settings.lowCutSlope = static_cast<CutFilter::Slope>(apvts.getRawParameterValue("lowCut Slope")->load());
     settings.drive = apvts.getRawParameterValue("drive")->load();
     settings.inputgain = apvts.getRawParameterValue("inputgain")->load();
     settings.outputgain = apvts.getRawParameterValue("outputgain")->load();
     settings.mix = apvts.getRawParameterValue("mix")->load();
-    settings.distortionMode = apvts.getRawParameterValue("distortion mode")->load();
+    settings.distortionMode = apvts.getRawParameterValue("neural amp")->load() > 0.5f ? ChainSettings::neuralAmpMode
+                                                                                     : (int)apvts.getRawParameterValue("distortion mode")->load();
     settings.powerSwitch = apvts.getRawParameterValue("power switch")->load() > 0.5f;
     settings.driveBypassed = apvts.getRawParameterValue("drive Bypass")->load() > 0.5f;
     settings.highCutBypassed = apvts.getRawParameterValue("highCut Bypass")->load() > 0.5f;
     settings.lowCutBypassed = apvts.getRawParameterValue("lowCut Bypass")->load() > 0.5f;
     settings.inputgainBypassed = apvts.getRawParameterValue("inputGain Bypass")->load() > 0.5f;
     settings.outputgainBypassed = apvts.getRawParameterValue("outputGain Bypass")->load() > 0.5f;
+    settings.oversampling = (int)apvts.getRawParameterValue("oversampling")->load();
     
+    settings.multiband = apvts.getRawParameterValue("multiband")->load() > 0.5f;
+    settings.parallelBands = apvts.getRawParameterValue("parallel bands")->load() > 0.5f;
     
-    return settings;
-}
-
-
-void updateCoefficients(Coefficients &old, const Coefficients &replacement)
-{
-    *old = *replacement;
-}
-
-void DistortionProjAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings)
-{
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::lowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::lowCut>();
+    settings.dynamics.amount = apvts.getRawParameterValue("dynamics")->load();
+    settings.dynamics.attackMs = apvts.getRawParameterValue("dynamics attack")->load();
+    settings.dynamics.releaseMs = apvts.getRawParameterValue("dynamics release")->load();
+    settings.dynamics.lookaheadMs = apvts.getRawParameterValue("lookahead")->load();
     
-    leftChain.setBypassed<ChainPositions::lowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::lowCut>(chainSettings.lowCutBypassed);
-
+    settings.emphasis = apvts.getRawParameterValue("emphasis")->load();
+    settings.emphasisFreq = apvts.getRawParameterValue("emphasis freq")->load();
+    settings.bands.numBands = (int)apvts.getRawParameterValue("band count")->load();
     
-    updateCutFilter(leftLowCut, lowCutCoefficients);
-    updateCutFilter(rightLowCut, lowCutCoefficients);
-}
-
-void DistortionProjAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings)
-{
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::highCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::highCut>();
+    for(int i = 0; i < MultibandDistortion::numCrossovers; ++i){
+        settings.bands.crossoverFreqs[i] = apvts.getRawParameterValue(crossoverFreqIds[i])->load();
+    }
     
-    leftChain.setBypassed<ChainPositions::highCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::highCut>(chainSettings.highCutBypassed);
-
-    updateCutFilter(leftHighCut, highCutCoefficients);
-    updateCutFilter(rightHighCut, highCutCoefficients);
+    for(int i = 0; i < MultibandDistortion::maxBands; ++i){
+        settings.bands.drive[i] = apvts.getRawParameterValue(bandDriveIds[i])->load();
+        settings.bands.mix[i] = apvts.getRawParameterValue(bandMixIds[i])->load();
+    }
+    
+    
+    return settings;
 }
 
-void DistortionProjAudioProcessor::updateFilters()
+
+// the filters skip the redesign themselves when nothing has changed
+void DistortionProjAudioProcessor::updateFilters(const ChainSettings &chainSettings)
 {
-    auto chainSettings = getChainSettings(apvts);
-    
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
+    lowCutFilter.setParameters(chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+    highCutFilter.setParameters(chainSettings.highCutFreq, chainSettings.highCutSlope);
 }
 
 
@@ -468,6 +891,101 @@ AudioProcessorValueTreeState::ParameterLayout DistortionProjAudioProcessor::crea
                                                     "Power switch",
                                                     true
                                                     ));
+    
+    // its own switch rather than an eighth "distortion mode" choice, so automation written against
+    // the seven choices still lands on the same modes
+    layout.add(std::make_unique<AudioParameterBool>("neural amp",
+                                                    "Neural Amp",
+                                                    false
+                                                    ));
+    
+    // off by default, so sessions from before it existed sound the same
+    StringArray oversamplingChoices;
+    oversamplingChoices.add("Off");
+    oversamplingChoices.add("2x");
+    oversamplingChoices.add("4x");
+    
+    layout.add(std::make_unique<AudioParameterChoice>("oversampling",
+                                                      "Oversampling",
+                                                      oversamplingChoices,
+                                                      0));
+    
+    layout.add(std::make_unique<AudioParameterFloat>("dynamics",
+                                                     "Dynamics",
+                                                     NormalisableRange<float>(-100.f, 100.f, 1.f, 1.f),
+                                                     0.f));
+    layout.add(std::make_unique<AudioParameterFloat>("dynamics attack",
+                                                     "Dynamics Attack",
+                                                     NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f),
+                                                     5.f));
+    layout.add(std::make_unique<AudioParameterFloat>("dynamics release",
+                                                     "Dynamics Release",
+                                                     NormalisableRange<float>(5.f, 1000.f, 1.f, 0.4f),
+                                                     100.f));
+    layout.add(std::make_unique<AudioParameterFloat>("lookahead",
+                                                     "Lookahead",
+                                                     NormalisableRange<float>(0.f, (float)(DynamicDrive::maxLookaheadSeconds * 1000.0), 0.1f, 1.f),
+                                                     0.f));
+    
+    layout.add(std::make_unique<AudioParameterFloat>("emphasis",
+                                                     "Emphasis",
+                                                     NormalisableRange<float>(-18.f, 18.f, 0.5f, 1.f),
+                                                     0.f));
+    layout.add(std::make_unique<AudioParameterFloat>("emphasis freq",
+                                                     "Emphasis Freq",
+                                                     NormalisableRange<float>(100.f, 8000.f, 1.f, 0.3f),
+                                                     800.f));
+    
+    layout.add(std::make_unique<AudioParameterBool>("multiband",
+                                                    "Multiband",
+                                                    false
+                                                    ));
+    layout.add(std::make_unique<AudioParameterBool>("parallel bands",
+                                                    "Parallel Bands",
+                                                    false
+                                                    ));
+    layout.add(std::make_unique<AudioParameterInt>("band count",
+                                                   "Band Count",
+                                                   2,
+                                                   MultibandDistortion::maxBands,
+                                                   3
+                                                   ));
+    
+    const float crossoverDefaults[] = { 400.f, 2000.f, 6000.f, 12000.f };
+    for(int i = 0; i < MultibandDistortion::numCrossovers; ++i){
+        layout.add(std::make_unique<AudioParameterFloat>(crossoverFreqIds[i],
+                                                         "Crossover " + String(i + 1) + " Freq",
+                                                         NormalisableRange<float>(20.f, 16000.f, 1.f, 0.25f),
+                                                         crossoverDefaults[i]));
+    }
+    
+    for(int i = 0; i < MultibandDistortion::maxBands; ++i){
+        layout.add(std::make_unique<AudioParameterFloat>(bandDriveIds[i],
+                                                         "Band " + String(i + 1) + " Drive",
+                                                         NormalisableRange<float>(0.f, 20.f, 0.5f, 1.f),
+                                                         0.f));
+        layout.add(std::make_unique<AudioParameterFloat>(bandMixIds[i],
+                                                         "Band " + String(i + 1) + " Mix",
+                                                         NormalisableRange<float>(0.f, 100.f, 1.f, 1.f),
+                                                         50.f));
+    }
+    
+    // the cuts were always 6 dB/Oct before these existed, so that's the default
+    StringArray slopes;
+    slopes.add("6 dB/Oct");
+    for(int i = 0; i < 4; ++i)
+    {
+        slopes.add(String(12 + i * 12) + " dB/Oct");
+    }
+    
+    layout.add(std::make_unique<AudioParameterChoice>("lowCut Slope",
+                                                      "lowCut Slope",
+                                                      slopes,
+                                                      0));
+    layout.add(std::make_unique<AudioParameterChoice>("highCut Slope",
+                                                      "highCut Slope",
+                                                      slopes,
+                                                      0));
             
     return layout;
     
@@ -9,6 +9,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "NeuralShaper.h"
+#include "RealtimeSafety.h"
+#include "StageProfiler.h"
+#include "HostLoadMonitor.h"
+#include "QualityGovernor.h"
+#include "SilenceDetector.h"
+#include "BypassManager.h"
+#include "MultibandDistortion.h"
+#include "DynamicDrive.h"
+#include "EmphasisEQ.h"
+#include "CutFilter.h"
 
 template<typename T>
 struct Fifo
@@ -160,55 +171,36 @@ private:
 struct ChainSettings{
     
     float lowCutFreq {0}, highCutFreq {0}, inputgain {0}, outputgain {0}, drive {0}, mix {0};
+    CutFilter::Slope lowCutSlope {CutFilter::slope6}, highCutSlope {CutFilter::slope6};
+    
+    // the "distortion mode" choice, or neuralAmpMode while the separate "neural amp" switch is on
+    static constexpr int neuralAmpMode = 7;
     int distortionMode {0};
     bool powerSwitch {true}, driveBypassed {false}, lowCutBypassed {false}, highCutBypassed {false},
         inputgainBypassed {false}, outputgainBypassed {false};
+    
+    // replaces drive and mix with the per band ones for the clipper and saturator modes
+    bool multiband {false}, parallelBands {false};
+    MultibandDistortion::Settings bands;
+    
+    // moves the drive (or every band's) with the input level
+    DynamicDrive::Settings dynamics;
+    
+    // 2^order times the rate for the analytic modes, as asked for; the quality governor can lower it
+    int oversampling {0};
+    
+    // tilt into the distortion and back out, dB at the pivot frequency
+    float emphasis {0}, emphasisFreq {800};
 };
 
 ChainSettings getChainSettings(AudioProcessorValueTreeState& apvts);
 
-
-
-using Filter = dsp::IIR::Filter<float>;
-
-using MonoChain = dsp::ProcessorChain<Filter, Filter>;
-//    using MonoChain = dsp::ProcessorChain<Gain, Filter, Filter, WaveShape, Gain>;
-
-
-enum ChainPositions
-{
-    lowCut,
-    highCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-
-void updateCoefficients(Coefficients& old, const Coefficients& replacement);
-
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.coefficients, coefficients[0]);
-//        chain.template setBypassed<Index>(false);
-}
-
-
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 1) ;
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 1);
-}
-
 //==============================================================================
 /**
 */
-class DistortionProjAudioProcessor  : public juce::AudioProcessor
+class DistortionProjAudioProcessor  : public juce::AudioProcessor,
+                                      public juce::ChangeBroadcaster,
+                                      private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -254,6 +246,26 @@ public:
     void savePreset();
     void loadPreset();
     
+    // the last analysed image is saved with the session, so reopening a project can show it again
+    // without decoding or analysing the original image. Restoring a state sends a change message
+    // so an open editor can pick up the new analysis.
+    void setImageAnalysis(const MemoryBlock& thumbnailJpeg, const String& description);
+    void clearImageAnalysis();
+    ValueTree getImageAnalysis() const;
+    
+    // amp captures from the CLI's --capture command play in the neural amp mode and are saved
+    // with the session the same way
+    bool setCaptureModel(const MemoryBlock& modelData);
+    bool loadCaptureModel();
+    
+    // per-stage timing of processBlock(), only filled in while the editor's profile is showing
+    StageProfiler& getStageProfiler() { return stageProfiler; }
+    bool saveStageProfile() const;
+    
+    // processBlock() time against the block's real-time deadline
+    const HostLoadMonitor& getLoadMonitor() const { return loadMonitor; }
+    const QualityGovernor& getQualityGovernor() const { return qualityGovernor; }
+    
     juce::AudioProcessorValueTreeState apvts {
         *this,
         nullptr,
@@ -295,12 +307,78 @@ private:
     using Clipper = viator_dsp::Clipper<float>;
     using Saturator = viator_dsp::Saturation<float>;
     
-    MonoChain leftChain, rightChain;
+    CutFilter lowCutFilter {CutFilter::highpass}, highCutFilter {CutFilter::lowpass};
 
     Gain outputGain, inputGain;
     
-    Clipper softClipper, hardClipper, diodeDistortion;
-    Saturator saturation, tubeDistortion, tapeDistortion;
+    // the analytic modes, one set per oversampling order so each stays prepared at its own rate
+    struct DistortionModules
+    {
+        Clipper softClipper, hardClipper, diodeDistortion;
+        Saturator saturation, tubeDistortion, tapeDistortion;
+        MultibandDistortion multiband;
+    };
+    
+    NeuralShaper neuralShaper;
+    DynamicDrive dynamicDrive;
+    EmphasisEQ emphasisEQ;
+    std::atomic<int> reportedLatency {0};
+    
+    // started in prepareToPlay() on machines with cores to spare, used when "parallel bands" is on
+    std::unique_ptr<RealtimeWorkerPool> workerPool;
+    
+    StageProfiler stageProfiler;
+    HostLoadMonitor loadMonitor;
+    QualityGovernor qualityGovernor;
+    SilenceDetector silenceDetector;
+    BypassManager bypasses;
+    
+    // how long the chain takes to ring down to -120dBFS with the current settings, kept here
+    // so getTailLengthSeconds() doesn't need to read the parameters itself
+    std::atomic<double> tailLengthSeconds {0};
+    static double calculateTailLengthSeconds(const ChainSettings& settings);
+    
+    // The analytic distortion modes can run oversampled, one oversampler per order (none at 1x);
+    // the neural amp never is, its models are trained at the session's sample rate. The order in
+    // use is the "oversampling" parameter, lowered by the quality governor when the load is high.
+    static constexpr int numOversamplingOrders = 3;
+    std::array<std::unique_ptr<dsp::Oversampling<float>>, numOversamplingOrders> oversamplers;
+    std::array<DistortionModules, numOversamplingOrders> distortionModules;
+    
+    // The oversamplers are linear phase, so their latency is a plain delay. Every order's path is
+    // padded out to the latency of the highest order the parameter allows, and the modes that
+    // don't oversample to all of it, so the orders line up when they crossfade and the latency
+    // the host sees only changes with the "oversampling" parameter itself.
+    std::array<int, numOversamplingOrders> oversamplerLatency {};
+    std::array<dsp::DelayLine<float, dsp::DelayLineInterpolationTypes::None>, numOversamplingOrders> alignmentDelays;
+    dsp::ProcessSpec baseSpec;
+    int oversamplingOrder {-1};
+    
+    // the block as it came into the distortion, for the outgoing order while the orders crossfade
+    AudioBuffer<float> switchBuffer;
+    
+    static bool isOversampledMode(int distortionMode) { return distortionMode >= 1 && distortionMode <= 6; }
+    static int getOversamplingOrder(const ChainSettings& settings, int qualityLevel);
+    
+    // the lookahead plus the distortion stage's, which is the same for every order, mode and
+    // quality level that a given "oversampling" setting can end up running
+    int calculateLatencySamples(const ChainSettings& settings) const;
+    int getDistortionLatency(const ChainSettings& settings) const { return oversamplerLatency[(size_t)settings.oversampling]; }
+    
+    // prepareDistortion() is for when nothing is playing through the order's modules, since
+    // they ramp up from dry afterwards; primeDistortion() brings them in already at the settings
+    void prepareDistortion(int order);
+    void primeDistortion(int order, const ChainSettings& settings);
+    dsp::ProcessSpec getDistortionSpec(int order) const;
+    
+    // oversampling, drive and the way back down for one order
+    void processDistortionStage(dsp::AudioBlock<float> block, const ChainSettings& settings, int order);
+    
+    // everything processBlock() does while the power switch is on
+    void processChain(juce::AudioBuffer<float>& buffer, const ChainSettings& settings);
+    void processDistortion(DistortionModules& modules, const dsp::ProcessContextReplacing<float>& context, const ChainSettings& settings, float driveOffset);
+    void handleAsyncUpdate() override;
+    void resetChainState();
     
     AudioParameterFloat* outputGainParam {nullptr};
     AudioParameterFloat* inputGainParam {nullptr};
@@ -330,6 +408,12 @@ private:
     
     float rmsInLevelLeft, rmsInLevelRight, rmsOutLevelLeft, rmsOutLevelRight;
     
+    ValueTree imageAnalysis {"ImageAnalysis"};
+    RealtimeSafety::CriticalSection imageAnalysisLock;
+    
+    ValueTree captureModel {"CaptureModel"};
+    RealtimeSafety::CriticalSection captureModelLock;
+    
     template<typename T, typename U>
     void applyGain(T& buffer, U& gain)
     {
@@ -339,11 +423,7 @@ private:
     }
 
         
-    void updateHighCutFilters(const ChainSettings& chainSettings);
-    
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    
-    void updateFilters();
+    void updateFilters(const ChainSettings& chainSettings);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DistortionProjAudioProcessor)
 };
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.h
+    Created: 21 Oct 2026 10:03:17am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StageProfiler.h"
+
+namespace Gui
+{
+    // a table of the stage profiler's figures drawn over the response curve; the profiler only
+    // records while it's shown
+    class ProfilerOverlay : public Component, public Timer
+    {
+    public:
+        ProfilerOverlay(StageProfiler& p) : profiler(p)
+        {
+            setInterceptsMouseClicks(false, false);
+        }
+        
+        ~ProfilerOverlay() override
+        {
+            profiler.setRecording(false);
+        }
+        
+        void visibilityChanged() override
+        {
+            profiler.setRecording(isVisible());
+            
+            if(isVisible()){
+                startTimerHz(4);
+            }
+            else{
+                stopTimer();
+            }
+        }
+        
+        void timerCallback() override
+        {
+            repaint();
+        }
+        
+        void paint(Graphics& g) override
+        {
+            g.fillAll(Colours::black.withAlpha(0.75f));
+            
+            auto bounds = getLocalBounds().reduced(8);
+            const auto rowHeight = jmin(16, bounds.getHeight() / (StageProfiler::numStages + 2));
+            g.setFont((float)rowHeight * 0.8f);
+            
+            if(!StageProfiler::isAvailable())
+            {
+                g.setColour(Colours::lightgrey);
+                g.drawFittedText("Built with SENTIFIER_STAGE_PROFILING=0", bounds, Justification::centred, 1);
+                return;
+            }
+            
+            auto drawRow = [&](const StringArray& cells, Colour colour)
+            {
+                auto row = bounds.removeFromTop(rowHeight);
+                const auto firstColumn = row.getWidth() / 4;
+                const auto column = (row.getWidth() - firstColumn) / jmax(1, cells.size() - 1);
+                
+                g.setColour(colour);
+                g.drawText(cells[0], row.removeFromLeft(firstColumn), Justification::centredLeft);
+                for(int i = 1; i < cells.size(); ++i){
+                    g.drawText(cells[i], row.removeFromLeft(column), Justification::centredRight);
+                }
+            };
+            
+            std::array<StageProfiler::Summary, StageProfiler::numStages> summaries;
+            double totalNs = 0;
+            for(int stage = 0; stage < StageProfiler::numStages; ++stage)
+            {
+                summaries[(size_t)stage] = profiler.getSummary(stage);
+                totalNs += summaries[(size_t)stage].totalNs;
+            }
+            
+            drawRow({"Stage", "mean us", "p50 us", "p99 us", "max us", "share"}, Colours::white);
+            
+            for(int stage = 0; stage < StageProfiler::numStages; ++stage)
+            {
+                const auto& s = summaries[(size_t)stage];
+                drawRow({ StageProfiler::getStageName(stage),
+                          String(s.meanNs * 0.001, 2),
+                          String(s.p50Ns * 0.001, 2),
+                          String(s.p99Ns * 0.001, 2),
+                          String(s.maxNs * 0.001, 2),
+                          String(totalNs > 0 ? 100.0 * s.totalNs / totalNs : 0.0, 1) + "%" },
+                        Colours::lightgrey);
+            }
+        }
+        
+    private:
+        StageProfiler& profiler;
+    };
+}
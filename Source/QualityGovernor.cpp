@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+    Created: 21 Oct 2026 4:12:30pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+QualityGovernor::Settings QualityGovernor::getSettings(int level)
+{
+    switch(level)
+    {
+        case full:      return { 2, 13, 60, 24 };
+        case reduced:   return { 1, 12, 30, 12 };
+        case minimum:
+        default:        return { 0, 11, 15, 6 };
+    }
+}
+
+void QualityGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    smoothedLoad = 0;
+    secondsOverThreshold = 0;
+    secondsUnderThreshold = 0;
+}
+
+void QualityGovernor::update(double blockLoad, int numSamples, bool isNonRealtime) noexcept
+{
+    if(isNonRealtime)
+    {
+        level.store(full, std::memory_order_relaxed);
+        smoothedLoad = 0;
+        secondsOverThreshold = secondsUnderThreshold = 0;
+        return;
+    }
+
+    const auto blockSeconds = numSamples / sampleRate;
+    smoothedLoad += (blockLoad - smoothedLoad) * (1.0 - std::exp(-blockSeconds / smoothingSeconds));
+
+    secondsOverThreshold = smoothedLoad > stepDownLoad ? secondsOverThreshold + blockSeconds : 0.0;
+    secondsUnderThreshold = smoothedLoad < stepUpLoad ? secondsUnderThreshold + blockSeconds : 0.0;
+
+    const auto current = getLevel();
+
+    if(secondsOverThreshold >= stepDownHoldSeconds && current < numLevels - 1)
+    {
+        level.store(current + 1, std::memory_order_relaxed);
+        secondsOverThreshold = 0;
+    }
+    else if(secondsUnderThreshold >= stepUpHoldSeconds && current > full)
+    {
+        level.store(current - 1, std::memory_order_relaxed);
+        secondsUnderThreshold = 0;
+    }
+}
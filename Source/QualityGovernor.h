@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Created: 21 Oct 2026 4:12:30pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Steps the plugin's quality down when processBlock() gets close to its deadline, and back up once
+// there's room again, so a heavy session degrades instead of dropping out. Each level caps the
+// distortion's oversampling and sets the editor's analyser FFT size and meter rates. The load is
+// smoothed, and a level has to be over stepDownLoad (or under stepUpLoad) for a hold time before
+// it changes; the gap between the two plus the longer hold going up keeps it from flapping.
+// Offline renders always run at full quality.
+class QualityGovernor
+{
+public:
+    enum Level
+    {
+        full,
+        reduced,
+        minimum,
+        numLevels
+    };
+
+    struct Settings
+    {
+        int oversamplingOrder;  // the most the "oversampling" parameter is allowed, 2^order times the rate
+        int fftOrder;
+        int analyserRateHz;
+        int meterRateHz;
+    };
+
+    static constexpr double stepDownLoad = 0.7;
+    static constexpr double stepUpLoad = 0.35;
+    static constexpr double smoothingSeconds = 0.25;
+    static constexpr double stepDownHoldSeconds = 0.25;
+    static constexpr double stepUpHoldSeconds = 5.0;
+
+    static Settings getSettings(int level);
+
+    void prepare(double sampleRate);
+
+    // audio thread, once per block with the previous block's share of its deadline
+    void update(double blockLoad, int numSamples, bool isNonRealtime) noexcept;
+
+    int getLevel() const noexcept { return level.load(std::memory_order_relaxed); }
+
+private:
+    double sampleRate {44100.0};
+    double smoothedLoad {0};
+    double secondsOverThreshold {0};
+    double secondsUnderThreshold {0};
+
+    std::atomic<int> level {full};
+};
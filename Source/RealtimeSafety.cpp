@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Created: 20 Oct 2026 7:21:40pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if SENTIFIER_RT_SAFETY_CHECKS
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace
+{
+    // plain ints so they're usable from operator new at any point in a thread's life
+    thread_local int audioThreadDepth = 0;
+    thread_local int permissionDepth = 0;
+    thread_local bool isReporting = false;
+
+    std::mutex& getViolationLock()
+    {
+        static std::mutex violationLock;
+        return violationLock;
+    }
+
+    // never destroyed, so allocations during static destruction can't touch a dead vector
+    std::vector<RealtimeSafety::Violation>& getViolationList()
+    {
+        static auto* violations = new std::vector<RealtimeSafety::Violation>();
+        return *violations;
+    }
+
+    void* allocate(std::size_t size)
+    {
+        RealtimeSafety::report("operator new");
+        return std::malloc(size > 0 ? size : 1);
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment)
+    {
+        RealtimeSafety::report("operator new");
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size > 0 ? size : 1, alignment);
+       #else
+        void* p = nullptr;
+        if(posix_memalign(&p, juce::jmax(alignment, sizeof(void*)), size > 0 ? size : 1) != 0)
+            return nullptr;
+        return p;
+       #endif
+    }
+
+    void deallocate(void* p)
+    {
+        if(p != nullptr)
+            RealtimeSafety::report("operator delete");
+
+        std::free(p);
+    }
+
+    void deallocateAligned(void* p)
+    {
+        if(p != nullptr)
+            RealtimeSafety::report("operator delete");
+
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+}
+
+RealtimeSafety::ScopedAudioThread::ScopedAudioThread()  { ++audioThreadDepth; }
+RealtimeSafety::ScopedAudioThread::~ScopedAudioThread() { --audioThreadDepth; }
+
+RealtimeSafety::ScopedPermission::ScopedPermission()    { ++permissionDepth; }
+RealtimeSafety::ScopedPermission::~ScopedPermission()   { --permissionDepth; }
+
+void RealtimeSafety::report(const char* what)
+{
+    if(audioThreadDepth == 0 || permissionDepth > 0 || isReporting)
+        return;
+
+    // everything from here allocates, which mustn't land back in here
+    isReporting = true;
+
+    const auto stackTrace = juce::SystemStats::getStackBacktrace();
+
+    {
+        const std::lock_guard<std::mutex> lock(getViolationLock());
+        auto& violations = getViolationList();
+
+        auto existing = std::find_if(violations.begin(), violations.end(), [&](const Violation& v)
+        {
+            return v.what == what && v.stackTrace == stackTrace;
+        });
+
+        if(existing != violations.end())
+        {
+            ++existing->count;
+        }
+        else
+        {
+            violations.push_back({ what, stackTrace, 1 });
+            DBG("Real-time safety: " << what << " on the audio thread\n" << stackTrace);
+        }
+    }
+
+    isReporting = false;
+}
+
+std::vector<RealtimeSafety::Violation> RealtimeSafety::getViolations()
+{
+    const ScopedPermission permission;
+    const std::lock_guard<std::mutex> lock(getViolationLock());
+    return getViolationList();
+}
+
+void RealtimeSafety::clearViolations()
+{
+    const ScopedPermission permission;
+    const std::lock_guard<std::mutex> lock(getViolationLock());
+    getViolationList().clear();
+}
+
+//==============================================================================
+// the replaceable global allocation functions, every form of them so nothing slips past
+
+void* operator new(std::size_t size)
+{
+    if(auto* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if(auto* p = allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if(auto* p = allocateAligned(size, (std::size_t)alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if(auto* p = allocateAligned(size, (std::size_t)alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, (std::size_t)alignment);
+}
+
+void operator delete(void* p) noexcept                                   { deallocate(p); }
+void operator delete[](void* p) noexcept                                 { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept                      { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept                    { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept            { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept          { deallocate(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept                 { deallocateAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept               { deallocateAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept    { deallocateAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept  { deallocateAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { deallocateAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(p); }
+
+#endif
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Created: 20 Oct 2026 7:21:40pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Build with SENTIFIER_RT_SAFETY_CHECKS=1 (the CLI's Debug configuration does) to catch the audio
+// thread doing things it shouldn't. While a thread is inside processBlock() every operator new and
+// delete it makes, and every lock it takes through RealtimeSafety::CriticalSection, is recorded
+// along with a stack trace. The CLI's --regress command fails if anything was recorded.
+//
+// With the checks off everything here compiles away to nothing, and the plugin builds never turn
+// them on.
+#ifndef SENTIFIER_RT_SAFETY_CHECKS
+ #define SENTIFIER_RT_SAFETY_CHECKS 0
+#endif
+
+namespace RealtimeSafety
+{
+    constexpr bool isEnabled() { return SENTIFIER_RT_SAFETY_CHECKS != 0; }
+
+    struct Violation
+    {
+        juce::String what;
+        juce::String stackTrace;
+        int count {0};
+    };
+
+   #if SENTIFIER_RT_SAFETY_CHECKS
+    // marks the calling thread as the audio thread for as long as it's in scope
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread();
+        ~ScopedAudioThread();
+    };
+
+    // lets the audio thread get away with it, for something known and already being fixed
+    struct ScopedPermission
+    {
+        ScopedPermission();
+        ~ScopedPermission();
+    };
+
+    // records a violation if the calling thread is the audio thread, anything that blocks
+    // (file access, waiting on another thread...) can call this to be caught too
+    void report(const char* what);
+
+    // each distinct stack trace once, with the number of times it was hit
+    std::vector<Violation> getViolations();
+    void clearViolations();
+
+    // a juce::CriticalSection that reports being entered on the audio thread
+    class CriticalSection
+    {
+    public:
+        void enter() const noexcept           { report("lock"); lock.enter(); }
+        bool tryEnter() const noexcept        { report("lock"); return lock.tryEnter(); }
+        void exit() const noexcept            { lock.exit(); }
+
+        using ScopedLockType = juce::GenericScopedLock<CriticalSection>;
+
+    private:
+        juce::CriticalSection lock;
+    };
+   #else
+    // user-provided constructors so unused instances don't warn
+    struct ScopedAudioThread { ScopedAudioThread() {} };
+    struct ScopedPermission { ScopedPermission() {} };
+
+    inline void report(const char*) {}
+    inline std::vector<Violation> getViolations() { return {}; }
+    inline void clearViolations() {}
+
+    using CriticalSection = juce::CriticalSection;
+   #endif
+}
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.cpp
+    Created: 23 Oct 2026 5:02:19pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "RealtimeWorkerPool.h"
+#include "RealtimeSafety.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <ctime>
+#endif
+
+namespace
+{
+    // juce::WaitableEvent takes a mutex to signal, these don't; posting only enters the kernel
+    // when there's a thread waiting
+    class Semaphore
+    {
+    public:
+       #if JUCE_MAC || JUCE_IOS
+        Semaphore() : semaphore(dispatch_semaphore_create(0)) {}
+        ~Semaphore() { dispatch_release(semaphore); }
+
+        void post() noexcept { dispatch_semaphore_signal(semaphore); }
+        void wait(int milliseconds) noexcept
+        {
+            dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)milliseconds * NSEC_PER_MSEC));
+        }
+
+    private:
+        dispatch_semaphore_t semaphore;
+       #elif JUCE_WINDOWS
+        Semaphore() : semaphore(CreateSemaphore(nullptr, 0, LONG_MAX, nullptr)) {}
+        ~Semaphore() { CloseHandle(semaphore); }
+
+        void post() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+        void wait(int milliseconds) noexcept { WaitForSingleObject(semaphore, (DWORD)milliseconds); }
+
+    private:
+        HANDLE semaphore;
+       #else
+        Semaphore() { sem_init(&semaphore, 0, 0); }
+        ~Semaphore() { sem_destroy(&semaphore); }
+
+        void post() noexcept { sem_post(&semaphore); }
+        void wait(int milliseconds) noexcept
+        {
+            timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += milliseconds / 1000;
+            deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000L;
+            if(deadline.tv_nsec >= 1000000000L)
+            {
+                ++deadline.tv_sec;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            sem_timedwait(&semaphore, &deadline);
+        }
+
+    private:
+        sem_t semaphore;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (Semaphore)
+    };
+}
+
+class RealtimeWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(RealtimeWorkerPool& p, int i) : juce::Thread("Sentifier worker " + juce::String(i)), pool(p) {}
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.post();
+        stopThread(1000);
+    }
+
+    void wake() noexcept
+    {
+        if(sleeping.load())
+            wakeUp.post();
+    }
+
+    void run() override
+    {
+        // the jobs are DSP like the audio thread's own, so they get the same denormal handling
+        juce::ScopedNoDenormals noDenormals;
+        RealtimeSafety::ScopedAudioThread audioThread;
+        auto lastGeneration = getGeneration(pool.state.load(std::memory_order_acquire));
+
+        while(!threadShouldExit())
+        {
+            if(waitForGeneration(lastGeneration))
+            {
+                lastGeneration = getGeneration(pool.state.load(std::memory_order_acquire));
+                pool.workOnJobs(lastGeneration);
+            }
+        }
+    }
+
+private:
+    // spins for roughly spinMicroseconds before going to sleep until woken
+    bool waitForGeneration(juce::uint32 lastGeneration) noexcept
+    {
+        static constexpr double spinMicroseconds = 50.0;
+        const auto spinUntil = juce::Time::getHighResolutionTicks()
+                             + juce::Time::secondsToHighResolutionTicks(spinMicroseconds * 1.0e-6);
+
+        while(juce::Time::getHighResolutionTicks() < spinUntil)
+        {
+            if(getGeneration(pool.state.load(std::memory_order_acquire)) != lastGeneration)
+                return true;
+
+            std::this_thread::yield();
+        }
+
+        // sequentially consistent with runJobs() publishing the next generation, so either it
+        // sees us asleep and posts, or we see the new generation here. A post that arrives after
+        // we've already seen it just makes the next wait return early.
+        sleeping.store(true);
+
+        if(getGeneration(pool.state.load()) == lastGeneration && !threadShouldExit())
+            wakeUp.wait(100);
+
+        sleeping.store(false);
+        return getGeneration(pool.state.load(std::memory_order_acquire)) != lastGeneration;
+    }
+
+    RealtimeWorkerPool& pool;
+    Semaphore wakeUp;
+    std::atomic<bool> sleeping {false};
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool(int numWorkers)
+{
+    for(int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+       #if JUCE_MAJOR_VERSION >= 7
+        worker->startThread(juce::Thread::Priority::highest);
+       #else
+        worker->startThread(9);
+       #endif
+    }
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    workers.clear();
+}
+
+void RealtimeWorkerPool::runJobs(int numJobs, JobFunction function, void* context) noexcept
+{
+    if(numJobs <= 0)
+        return;
+
+    if(workers.isEmpty() || numJobs == 1 || numJobs > 0xffff)
+    {
+        for(int i = 0; i < numJobs; ++i)
+            function(context, i);
+
+        return;
+    }
+
+    // every job of the previous call has finished, so nothing is reading these
+    jobFunction = function;
+    jobContext = context;
+    numFinished.store(0, std::memory_order_relaxed);
+
+    const auto generation = getGeneration(state.load(std::memory_order_relaxed)) + 1;
+    state.store(((juce::uint64)generation << 32) | ((juce::uint64)numJobs << 16));
+
+    for(auto* worker : workers)
+        worker->wake();
+
+    // the calling thread takes every job no worker has claimed yet, so nothing sits waiting for a
+    // worker to wake up
+    workOnJobs(generation);
+
+    // Every job has been handed out by now, so this only joins the ones a worker is already
+    // running. The wait has no upper bound: a worker the OS preempts mid-job holds the audio
+    // thread until it's scheduled again, and there's no way to take a job back once started.
+    // That's the price of parallel bands. The workers run at high priority with a core left
+    // free, and a band is a fraction of a block's work, so in practice it's a few microseconds.
+    while(numFinished.load(std::memory_order_acquire) < numJobs)
+        std::this_thread::yield();
+}
+
+void RealtimeWorkerPool::workOnJobs(juce::uint32 generation) noexcept
+{
+    auto current = state.load(std::memory_order_acquire);
+
+    for(;;)
+    {
+        const auto numJobs = (int)((current >> 16) & 0xffff);
+        const auto index = (int)(current & 0xffff);
+
+        if(getGeneration(current) != generation || index >= numJobs)
+            return;
+
+        if(state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            jobFunction(jobContext, index);
+            numFinished.fetch_add(1, std::memory_order_acq_rel);
+            current = state.load(std::memory_order_acquire);
+        }
+    }
+}
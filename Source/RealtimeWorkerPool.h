@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerPool.h
+    Created: 23 Oct 2026 5:02:19pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <thread>
+
+// A few threads started up front that the audio thread can hand independent jobs to (the
+// multiband engine's bands) and wait for before processBlock() returns. The audio thread takes
+// jobs too, so it's never just waiting. Between blocks the workers spin for a short while so
+// back to back blocks don't pay for a wake up, then sleep on a semaphore until the next one.
+//
+// parallelFor() doesn't allocate or take a lock. Waking a sleeping worker is one post to the OS
+// semaphore (dispatch_semaphore on macOS, a futex backed sem_t on Linux), which only goes into
+// the kernel when the worker is actually waiting. Small blocks aren't worth splitting up,
+// shouldRunInParallel() says when it is.
+//
+// The caller runs every job that no worker has claimed, then waits for the ones that were. That
+// last wait is unbounded, since a worker preempted mid-job can't be hurried, which is why the
+// multiband engine only uses the pool when "parallel bands" is switched on.
+class RealtimeWorkerPool
+{
+public:
+    // numWorkers threads besides the caller; they're left to the scheduler rather than pinned, as
+    // every plugin instance has its own pool and fixed cores would pile them all up together
+    explicit RealtimeWorkerPool(int numWorkers);
+    ~RealtimeWorkerPool();
+
+    int getNumWorkers() const noexcept { return workers.size(); }
+
+    // Below this many samples per job the hand off costs more than it saves and jobs run on the
+    // calling thread. The CLI's "--bench --filter Multiband" compares serial and parallel bands
+    // at each block size to find where that is on a given machine.
+    void setMinSamplesForParallel(int numSamples) noexcept { minSamplesForParallel = numSamples; }
+    bool shouldRunInParallel(int numJobs, int samplesPerJob) const noexcept
+    {
+        return numJobs > 1 && !workers.isEmpty() && samplesPerJob >= minSamplesForParallel;
+    }
+
+    // calls job(index) for every index in [0, numJobs) across the workers and the calling thread,
+    // and returns once all of them have finished
+    template <typename Job>
+    void parallelFor(int numJobs, Job& job) noexcept
+    {
+        runJobs(numJobs, [](void* context, int index) { (*static_cast<Job*>(context))(index); }, &job);
+    }
+
+private:
+    using JobFunction = void (*)(void*, int);
+
+    class Worker;
+
+    void runJobs(int numJobs, JobFunction function, void* context) noexcept;
+    void workOnJobs(juce::uint32 generation) noexcept;
+
+    static juce::uint32 getGeneration(juce::uint64 state) noexcept { return (juce::uint32)(state >> 32); }
+
+    juce::OwnedArray<Worker> workers;
+    int minSamplesForParallel {128};
+
+    JobFunction jobFunction {nullptr};
+    void* jobContext {nullptr};
+
+    // generation (32 bits), number of jobs (16) and next job to hand out (16) in one word, so a
+    // worker that wakes up late can't take a job from a later call than the one it woke for
+    std::atomic<juce::uint64> state {0};
+    std::atomic<int> numFinished {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeWorkerPool)
+};
@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    SilenceDetector.cpp
+    Created: 22 Oct 2026 10:05:12am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "SilenceDetector.h"
+
+void SilenceDetector::reset()
+{
+    inputSilent = false;
+    skipping = false;
+    silentSamples = 0;
+}
+
+bool SilenceDetector::shouldSkip(const juce::AudioBuffer<float>& buffer, float chainGain) noexcept
+{
+    inputSilent = getPeak(buffer) * chainGain < threshold;
+
+    if(!inputSilent)
+    {
+        skipping = false;
+        silentSamples = 0;
+    }
+
+    return skipping;
+}
+
+void SilenceDetector::processed(const juce::AudioBuffer<float>& buffer, int tailSamples) noexcept
+{
+    // the tail only counts down while nothing new is coming in and nothing is still ringing
+    if(!inputSilent || getPeak(buffer) >= threshold)
+    {
+        silentSamples = 0;
+        return;
+    }
+
+    silentSamples = juce::jmin(silentSamples + buffer.getNumSamples(), std::numeric_limits<int>::max() / 2);
+    skipping = silentSamples >= tailSamples;
+}
+
+float SilenceDetector::getPeak(const juce::AudioBuffer<float>& buffer) noexcept
+{
+    auto peak = 0.f;
+    for(int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        peak = juce::jmax(peak, buffer.getMagnitude(channel, 0, buffer.getNumSamples()));
+
+    return peak;
+}
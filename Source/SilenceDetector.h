@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    SilenceDetector.h
+    Created: 22 Oct 2026 10:05:12am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lets processBlock() skip the whole chain while a track is silent. Once the input has been
+// below -120dBFS, after whatever gain the chain could put on it, and the output has stayed there
+// for a full tail length, blocks are skipped until the input comes back. Nothing is reset while skipping, filter and smoother state had already
+// decayed to nothing by then.
+class SilenceDetector
+{
+public:
+    static constexpr float threshold = 1.0e-6f; // -120dBFS
+
+    void reset();
+
+    // before processing, with the input and the most the chain could lift it by, so a quiet input
+    // that the gain stages would bring up isn't mistaken for silence; true means skip the block
+    bool shouldSkip(const juce::AudioBuffer<float>& buffer, float chainGain) noexcept;
+
+    // after processing, with the output and the current tail length
+    void processed(const juce::AudioBuffer<float>& buffer, int tailSamples) noexcept;
+
+    bool isSkipping() const noexcept { return skipping; }
+
+    static float getPeak(const juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    bool inputSilent {false};
+    bool skipping {false};
+    int silentSamples {0};
+};
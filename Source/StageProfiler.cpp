@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    StageProfiler.cpp
+    Created: 21 Oct 2026 10:03:17am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "StageProfiler.h"
+
+StageProfiler::StageProfiler()
+{
+    reset();
+}
+
+const char* StageProfiler::getStageName(int stage)
+{
+    switch(stage)
+    {
+        case inputGain:       return "Input gain";
+        case inputMetering:   return "Input metering";
+        case distortion:      return "Distortion";
+        case cutFilters:      return "Cut filters";
+        case outputGain:      return "Output gain";
+        case outputMetering:  return "Output metering";
+        case analyserFifo:    return "Analyser FIFO";
+        default:            return "";
+    }
+}
+
+int StageProfiler::getBucket(juce::uint64 nanoseconds) noexcept
+{
+    if(nanoseconds < 16)
+        return 0;
+
+    const auto ns = (juce::uint32)juce::jmin(nanoseconds, (juce::uint64)0xffffffff);
+    const auto octave = juce::findHighestSetBit(ns);
+    const auto quarter = (int)((ns >> (octave - 2)) & 3);
+
+    return juce::jmin(numBuckets - 1, (octave - 4) * 4 + quarter);
+}
+
+double StageProfiler::getBucketCentre(int bucket) noexcept
+{
+    const auto octave = bucket / 4 + 4;
+    const auto width = (double)(1u << (octave - 2));
+    return (4 + bucket % 4) * width + width * 0.5;
+}
+
+void StageProfiler::record(int stage, juce::uint64 nanoseconds) noexcept
+{
+    auto& h = histograms[(size_t)stage];
+
+    h.buckets[(size_t)getBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    h.calls.fetch_add(1, std::memory_order_relaxed);
+    h.totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    // single writer, so a plain compare is enough
+    if(nanoseconds > h.maxNs.load(std::memory_order_relaxed))
+        h.maxNs.store(nanoseconds, std::memory_order_relaxed);
+}
+
+StageProfiler::Summary StageProfiler::getSummary(int stage) const
+{
+    const auto& h = histograms[(size_t)stage];
+
+    std::array<juce::uint64, numBuckets> counts;
+    juce::uint64 total = 0;
+    for(size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = h.buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary;
+    summary.calls = h.calls.load(std::memory_order_relaxed);
+    summary.totalNs = (double)h.totalNs.load(std::memory_order_relaxed);
+    summary.maxNs = (double)h.maxNs.load(std::memory_order_relaxed);
+    summary.meanNs = summary.calls > 0 ? summary.totalNs / (double)summary.calls : 0.0;
+
+    auto percentile = [&](double p)
+    {
+        const auto target = (juce::uint64)std::ceil(p * (double)total);
+        juce::uint64 seen = 0;
+        for(int i = 0; i < numBuckets; ++i)
+        {
+            seen += counts[(size_t)i];
+            if(seen >= target && seen > 0)
+                return juce::jmin(getBucketCentre(i), summary.maxNs);
+        }
+        return summary.maxNs;
+    };
+
+    summary.p50Ns = percentile(0.5);
+    summary.p99Ns = percentile(0.99);
+    return summary;
+}
+
+void StageProfiler::reset() noexcept
+{
+    for(auto& h : histograms)
+    {
+        for(auto& bucket : h.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+
+        h.calls.store(0, std::memory_order_relaxed);
+        h.totalNs.store(0, std::memory_order_relaxed);
+        h.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+juce::String StageProfiler::createReport() const
+{
+    std::array<Summary, numStages> summaries;
+    double totalNs = 0;
+    for(int stage = 0; stage < numStages; ++stage)
+    {
+        summaries[(size_t)stage] = getSummary(stage);
+        totalNs += summaries[(size_t)stage].totalNs;
+    }
+
+    juce::String report;
+    report << "Sentifier processBlock() stage profile, " << juce::Time::getCurrentTime().toISO8601(true) << "\n\n";
+    report << "stage,calls,mean_us,p50_us,p99_us,max_us,share_percent\n";
+
+    for(int stage = 0; stage < numStages; ++stage)
+    {
+        const auto& s = summaries[(size_t)stage];
+        report << getStageName(stage) << "," << (juce::int64)s.calls << ","
+               << s.meanNs * 0.001 << "," << s.p50Ns * 0.001 << "," << s.p99Ns * 0.001 << "," << s.maxNs * 0.001 << ","
+               << (totalNs > 0 ? 100.0 * s.totalNs / totalNs : 0.0) << "\n";
+    }
+
+    report << "\nbucket_centre_ns";
+    for(int stage = 0; stage < numStages; ++stage)
+        report << "," << getStageName(stage);
+    report << "\n";
+
+    for(int i = 0; i < numBuckets; ++i)
+    {
+        report << getBucketCentre(i);
+        for(const auto& h : histograms)
+            report << "," << (int)h.buckets[(size_t)i].load(std::memory_order_relaxed);
+        report << "\n";
+    }
+
+    return report;
+}
+
+bool StageProfiler::writeReport(const juce::File& file) const
+{
+    return file.replaceWithText(createReport());
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    StageProfiler.h
+    Created: 21 Oct 2026 10:03:17am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// Times each stage of processBlock() into a histogram per stage while recording is switched on,
+// which the editor does while the profile is on screen. The audio thread only does relaxed atomic
+// adds, so the editor can read the histograms (or dump them to a file) while the plugin runs.
+// With recording off a ScopedTimer costs one relaxed load and doesn't read the clock.
+//
+// Building with SENTIFIER_STAGE_PROFILING=0 takes it out altogether: ScopedTimer is an empty type
+// and processBlock() compiles to exactly what it was without the timers.
+#ifndef SENTIFIER_STAGE_PROFILING
+ #define SENTIFIER_STAGE_PROFILING 1
+#endif
+
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        inputGain,
+        inputMetering,
+        distortion,
+        cutFilters,
+        outputGain,
+        outputMetering,
+        analyserFifo,
+        numStages
+    };
+
+    static constexpr bool isAvailable()
+    {
+       #if SENTIFIER_STAGE_PROFILING
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    static const char* getStageName(int stage);
+
+    // quarter octave buckets from 16ns to about 1ms, anything outside ends up in the end buckets
+    static constexpr int numBuckets = 64;
+
+    struct Summary
+    {
+        juce::uint64 calls {0};
+        double totalNs {0}, meanNs {0}, p50Ns {0}, p99Ns {0}, maxNs {0};
+    };
+
+    StageProfiler();
+
+    // off to begin with, so nothing is timed until somebody looks
+    void setRecording(bool shouldRecord) noexcept { recording.store(shouldRecord && isAvailable(), std::memory_order_relaxed); }
+    bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+
+    // audio thread only, one writer per stage
+    void record(int stage, juce::uint64 nanoseconds) noexcept;
+
+    Summary getSummary(int stage) const;
+    void reset() noexcept;
+
+    // a table of every stage followed by the raw histograms as CSV
+    juce::String createReport() const;
+    bool writeReport(const juce::File& file) const;
+
+   #if SENTIFIER_STAGE_PROFILING
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(StageProfiler& p, Stage s) noexcept : profiler(p), stage(s), active(p.isRecording())
+        {
+            if(active)
+                start = Clock::now();
+        }
+
+        ~ScopedTimer() noexcept
+        {
+            if(!active)
+                return;
+
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            profiler.record(stage, (juce::uint64)juce::jmax((decltype(elapsed))0, elapsed));
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        StageProfiler& profiler;
+        Stage stage;
+        bool active;
+        Clock::time_point start;
+    };
+   #else
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(StageProfiler&, Stage) noexcept {}
+    };
+   #endif
+
+    static int getBucket(juce::uint64 nanoseconds) noexcept;
+    static double getBucketCentre(int bucket) noexcept;
+
+private:
+    struct Histogram
+    {
+        std::array<std::atomic<juce::uint32>, numBuckets> buckets;
+        std::atomic<juce::uint64> calls, totalNs, maxNs;
+    };
+
+    std::array<Histogram, numStages> histograms;
+    std::atomic<bool> recording {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageProfiler)
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Created: 20 Oct 2026 11:02:51am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include "OfflineRenderer.h"
+#include <deque>
+#include <numeric>
+
+namespace
+{
+    const juce::String audioWildcard {"*.wav;*.aif;*.aiff;*.flac;*.ogg"};
+
+    struct FileResult
+    {
+        OfflineRenderer::Result render;
+        int worker {-1};
+    };
+
+    // One deque of file indices per worker. A worker takes from the front of its own queue and,
+    // once that's empty, from the back of whichever queue has the most left.
+    class WorkStealingQueue
+    {
+    public:
+        WorkStealingQueue(int numWorkers) : queues((size_t)numWorkers) {}
+
+        void add(int worker, int item)
+        {
+            queues[(size_t)worker].items.push_back(item);
+        }
+
+        bool next(int worker, int& item)
+        {
+            auto& own = queues[(size_t)worker];
+            {
+                const juce::SpinLock::ScopedLockType lock(own.lock);
+                if(!own.items.empty())
+                {
+                    item = own.items.front();
+                    own.items.pop_front();
+                    return true;
+                }
+            }
+
+            for(;;)
+            {
+                Queue* victim = nullptr;
+                size_t mostLeft = 0;
+
+                for(auto& queue : queues)
+                {
+                    const juce::SpinLock::ScopedLockType lock(queue.lock);
+                    if(queue.items.size() > mostLeft)
+                    {
+                        mostLeft = queue.items.size();
+                        victim = &queue;
+                    }
+                }
+
+                if(victim == nullptr)
+                {
+                    return false;
+                }
+
+                // someone else may have emptied it since we looked, in which case look again
+                const juce::SpinLock::ScopedLockType lock(victim->lock);
+                if(!victim->items.empty())
+                {
+                    item = victim->items.back();
+                    victim->items.pop_back();
+                    return true;
+                }
+            }
+        }
+
+    private:
+        struct Queue
+        {
+            juce::SpinLock lock;
+            std::deque<int> items;
+        };
+
+        std::vector<Queue> queues;
+    };
+}
+
+void BatchRenderer::run(const juce::ArgumentList& args)
+{
+    auto inputFolder = args.getExistingFolderForOption("--batch");
+
+    auto outOption = args.getValueForOption("--out");
+    if(outOption.isEmpty())
+    {
+        juce::ConsoleApplication::fail("Expected --out <outputFolder>");
+    }
+
+    auto outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(outOption.unquoted());
+    if(!outputFolder.createDirectory().wasOk())
+    {
+        juce::ConsoleApplication::fail("Couldn't create " + outputFolder.getFullPathName());
+    }
+
+    auto getIntOption = [&args](const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    OfflineRenderer::Settings settings;
+    settings.blockSize = juce::jlimit(1, 65536, getIntOption("--block", settings.blockSize));
+    settings.bitsPerSample = juce::jmax(0, getIntOption("--bits", 0));
+
+    const auto extension = "." + (args.containsOption("--format") ? args.getValueForOption("--format") : juce::String("wav"));
+
+    auto files = inputFolder.findChildFiles(juce::File::findFiles, true, audioWildcard);
+
+    // don't pick up our own output if it's inside the input folder
+    files.removeIf([&](const juce::File& f) { return f.isAChildOf(outputFolder); });
+
+    if(files.isEmpty())
+    {
+        juce::ConsoleApplication::fail("No audio files found in " + inputFolder.getFullPathName());
+    }
+
+    const auto numWorkers = juce::jlimit(1, files.size(), getIntOption("--threads", juce::SystemStats::getNumCpus()));
+
+    // the processors are built here rather than on the workers, their constructors aren't ours to make thread safe
+    std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+    for(int i = 0; i < numWorkers; ++i)
+    {
+        renderers.push_back(std::make_unique<OfflineRenderer>());
+        if(renderers.back()->getFormatManager().findFormatForFileExtension(extension) == nullptr)
+        {
+            juce::ConsoleApplication::fail("Unknown output format " + extension);
+        }
+    }
+
+    if(args.containsOption("--preset"))
+    {
+        auto presetFile = args.getExistingFileForOption("--preset");
+        for(auto& renderer : renderers)
+        {
+            if(!renderer->loadPreset(presetFile))
+            {
+                juce::ConsoleApplication::fail("Couldn't load preset " + presetFile.getFullPathName());
+            }
+        }
+    }
+
+    // largest first, dealt round robin, so the queues start roughly balanced
+    std::vector<int> order((size_t)files.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return files[a].getSize() > files[b].getSize(); });
+
+    WorkStealingQueue queue(numWorkers);
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        queue.add((int)(i % (size_t)numWorkers), order[i]);
+    }
+
+    std::vector<FileResult> results((size_t)files.size());
+    std::atomic<int> finished {0};
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(numWorkers);
+        juce::WaitableEvent done;
+        std::atomic<int> remaining {numWorkers};
+
+        for(int worker = 0; worker < numWorkers; ++worker)
+        {
+            pool.addJob([&, worker]
+            {
+                auto& renderer = *renderers[(size_t)worker];
+                int index = 0;
+
+                while(queue.next(worker, index))
+                {
+                    const auto& input = files[index];
+                    // the source's own extension stays in the name, so take.wav and take.flac
+                    // become take.wav.flac and take.flac.flac rather than both writing take.flac
+                    auto output = outputFolder.getChildFile(input.getRelativePathFrom(inputFolder) + extension);
+                    output.getParentDirectory().createDirectory();
+
+                    auto& result = results[(size_t)index];
+                    result.worker = worker;
+                    result.render = renderer.render(input, output, settings);
+
+                    const auto count = ++finished;
+                    if(count % 25 == 0)
+                        std::cout << count << "/" << files.size() << " files" << std::endl;
+                }
+
+                if(--remaining == 0)
+                    done.signal();
+            });
+        }
+
+        done.wait();
+    }
+
+    const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    int failures = 0;
+    double audioSeconds = 0, processingSeconds = 0;
+    juce::int64 numSamples = 0;
+
+    std::cout << std::endl;
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i].render;
+        const auto name = files[(int)i].getRelativePathFrom(inputFolder);
+
+        if(!result.ok)
+        {
+            ++failures;
+            std::cout << "Failed: " << name << ": " << result.error << std::endl;
+            continue;
+        }
+
+        audioSeconds += result.audioSeconds;
+        processingSeconds += result.processingSeconds;
+        numSamples += result.numSamples;
+
+        std::cout << name << ": " << result.audioSeconds << " s audio, " << result.wallSeconds * 1000.0 << " ms wall, "
+                  << result.getRealTimeFactor() << "x real time, block load p99 " << result.load.p99 * 100.0
+                  << "% max " << result.load.max * 100.0 << "% (worker " << results[i].worker << ")" << std::endl;
+    }
+
+    std::cout << std::endl
+              << "Files:       " << files.size() << " (" << failures << " failed)" << std::endl
+              << "Workers:     " << numWorkers << std::endl
+              << "Wall time:   " << elapsed << " s" << std::endl
+              << "Audio:       " << audioSeconds << " s, " << numSamples << " samples" << std::endl
+              << "Throughput:  " << audioSeconds / juce::jmax(elapsed, 1.0e-6) << "x real time, "
+                                 << (double)numSamples / juce::jmax(elapsed, 1.0e-6) << " samples/s" << std::endl
+              << "Processing:  " << processingSeconds << " s in processBlock across all workers" << std::endl
+              << "Output in:   " << outputFolder.getFullPathName() << std::endl;
+
+    if(failures > 0)
+    {
+        juce::ConsoleApplication::fail(juce::String(failures) + " files could not be rendered", 1);
+    }
+}
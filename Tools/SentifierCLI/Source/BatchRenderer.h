@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+    Created: 20 Oct 2026 11:02:51am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Renders a whole folder of audio through the plugin, one processor per worker thread. Files are
+// dealt out largest first across per-worker queues and idle workers steal from the busiest queue,
+// so one long stem doesn't leave the other cores waiting at the end.
+namespace BatchRenderer
+{
+    // --batch <inputFolder> --out <outputFolder> [--preset <preset.xml>] [--threads <n>]
+    //         [--block <n>] [--format wav|flac|aiff] [--bits <n>]
+    void run(const juce::ArgumentList& args);
+}
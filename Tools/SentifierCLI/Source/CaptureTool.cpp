@@ -0,0 +1,447 @@
+/*
+  ==============================================================================
+
+    CaptureTool.cpp
+    Created: 19 Oct 2026 9:48:10pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "CaptureTool.h"
+#include "GruTrainer.h"
+#include "../../../Source/NeuralShaper.h"
+
+namespace
+{
+    using Curve = NeuralShaper::Curve;
+    using Trainer = GruTrainer<NeuralShaper::hiddenSize>;
+    using Weights = GruWeights<NeuralShaper::hiddenSize>;
+
+    // the recording can lag the test signal by up to this much
+    constexpr double maxLatencySeconds = 1.0;
+
+    // samples used for the cross-correlation and for fitting the curve
+    constexpr int maxAlignmentSamples = 1 << 20;
+    constexpr int maxCurveSamples = 1 << 18;
+
+    // the shelves need a moment to settle before their output is scored
+    constexpr int curveSettleSamples = 4096;
+
+    constexpr int segmentLength = 2048;
+    constexpr int warmUpLength = 512;
+    constexpr int segmentsPerJob = 4;
+    constexpr int maxValidationSamples = 1 << 16;
+
+    juce::AudioBuffer<float> readMono(juce::AudioFormatManager& formats, const juce::File& file, double& sampleRate)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if(reader == nullptr)
+        {
+            juce::ConsoleApplication::fail("Couldn't read " + file.getFullPathName());
+        }
+
+        // only the first channel is used, captures are mono
+        juce::AudioBuffer<float> buffer(1, (int)reader->lengthInSamples);
+        reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, false);
+
+        sampleRate = reader->sampleRate;
+        return buffer;
+    }
+
+    // runs body(0) ... body(count - 1) on the pool and waits for all of them
+    void parallelFor(juce::ThreadPool& pool, int count, const std::function<void(int)>& body)
+    {
+        std::atomic<int> remaining { count };
+        juce::WaitableEvent done;
+
+        for(int i = 0; i < count; ++i)
+        {
+            pool.addJob([&, i]
+            {
+                body(i);
+                if(--remaining == 0)
+                    done.signal();
+            });
+        }
+
+        if(count > 0)
+            done.wait();
+    }
+
+    // Lag (in samples) of wet behind dry, from the peak of their cross-correlation computed with
+    // one forward FFT each and one inverse. A negative peak means the unit inverts polarity.
+    int findLatency(const juce::AudioBuffer<float>& dry, const juce::AudioBuffer<float>& wet, int maxLag, bool& inverted)
+    {
+        const auto dryLength = juce::jmin(dry.getNumSamples(), maxAlignmentSamples);
+        const auto wetLength = juce::jmin(wet.getNumSamples(), maxAlignmentSamples);
+
+        const auto order = juce::jmax(1, (int)std::ceil(std::log2((double)(dryLength + wetLength))));
+        const auto size = 1 << order;
+
+        juce::dsp::FFT fft(order);
+        std::vector<float> dryData((size_t)size * 2, 0.f), wetData((size_t)size * 2, 0.f);
+
+        std::copy(dry.getReadPointer(0), dry.getReadPointer(0) + dryLength, dryData.begin());
+        std::copy(wet.getReadPointer(0), wet.getReadPointer(0) + wetLength, wetData.begin());
+
+        fft.performRealOnlyForwardTransform(dryData.data());
+        fft.performRealOnlyForwardTransform(wetData.data());
+
+        // wet * conj(dry), in place in wetData
+        auto* d = reinterpret_cast<std::complex<float>*>(dryData.data());
+        auto* w = reinterpret_cast<std::complex<float>*>(wetData.data());
+        for(int i = 0; i < size; ++i)
+            w[i] *= std::conj(d[i]);
+
+        fft.performRealOnlyInverseTransform(wetData.data());
+
+        int bestLag = 0;
+        float bestValue = 0;
+
+        for(int lag = -maxLag; lag <= maxLag; ++lag)
+        {
+            const auto value = wetData[(size_t)((lag + size) % size)];
+            if(std::abs(value) > std::abs(bestValue))
+            {
+                bestValue = value;
+                bestLag = lag;
+            }
+        }
+
+        inverted = bestValue < 0;
+        return bestLag;
+    }
+
+    //==============================================================================
+    struct CurveFit
+    {
+        float preLowGain {0}, preHighGain {0}, postLowGain {0}, postHighGain {0};
+        std::vector<float> coefficients;
+        double errorToSignal {std::numeric_limits<double>::max()};
+    };
+
+    void applyShelves(std::vector<float>& signal, double sampleRate, float lowGain, float highGain)
+    {
+        Curve::Shelf low, high;
+        low.prepare({ sampleRate, (juce::uint32)signal.size(), 1 });
+        high.prepare({ sampleRate, (juce::uint32)signal.size(), 1 });
+        Curve::configureShelf(low, true, lowGain);
+        Curve::configureShelf(high, false, highGain);
+
+        for(auto& x : signal)
+            x = high.processSample(low.processSample(x, 0.f), 0.f);
+    }
+
+    // With the shelves fixed the output is linear in the polynomial's coefficients,
+    // y = sum c_k post(pre(x)^k), so each candidate is an ordinary least squares problem.
+    CurveFit fitPolynomial(const std::vector<float>& dry, const std::vector<float>& wet, double sampleRate,
+                           int order, float inputRange, CurveFit shelves)
+    {
+        auto pre = dry;
+        applyShelves(pre, sampleRate, shelves.preLowGain, shelves.preHighGain);
+
+        const auto numSamples = (Eigen::Index)dry.size() - curveSettleSamples;
+        Eigen::MatrixXd basis(numSamples, order + 1);
+        std::vector<float> power(dry.size());
+
+        // work in x / inputRange so the powers stay near 1
+        for(int k = 0; k <= order; ++k)
+        {
+            for(size_t i = 0; i < pre.size(); ++i)
+                power[i] = std::pow(juce::jlimit(-1.f, 1.f, pre[i] / inputRange), (float)k);
+
+            applyShelves(power, sampleRate, shelves.postLowGain, shelves.postHighGain);
+
+            for(Eigen::Index i = 0; i < numSamples; ++i)
+                basis(i, k) = power[(size_t)(i + curveSettleSamples)];
+        }
+
+        Eigen::VectorXd target(numSamples);
+        for(Eigen::Index i = 0; i < numSamples; ++i)
+            target[i] = wet[(size_t)(i + curveSettleSamples)];
+
+        // a touch of ridge keeps high orders from blowing up on narrow band test signals
+        Eigen::MatrixXd normal = basis.transpose() * basis;
+        normal.diagonal().array() += 1.0e-9 * normal.trace();
+        const Eigen::VectorXd c = normal.ldlt().solve(basis.transpose() * target);
+
+        shelves.errorToSignal = (basis * c - target).squaredNorm() / juce::jmax(1.0e-12, target.squaredNorm());
+        shelves.coefficients.resize((size_t)order + 1);
+        for(int k = 0; k <= order; ++k)
+            shelves.coefficients[(size_t)k] = (float)(c[k] / std::pow((double)inputRange, (double)k));
+
+        return shelves;
+    }
+
+    // coordinate search: pre shelves with a flat post, post shelves with the best pre, then pre again
+    CurveFit fitCurve(const std::vector<float>& dry, const std::vector<float>& wet, double sampleRate,
+                      int order, float& inputRange, juce::ThreadPool& pool)
+    {
+        const float gains[] { -12.f, -6.f, 0.f, 6.f, 12.f };
+        constexpr int numGains = (int)std::size(gains);
+
+        CurveFit best;
+
+        for(int pass = 0; pass < 3; ++pass)
+        {
+            const bool fitPre = pass != 1;
+            std::vector<CurveFit> candidates((size_t)(numGains * numGains));
+
+            parallelFor(pool, (int)candidates.size(), [&](int i)
+            {
+                auto shelves = best;
+                auto& low = fitPre ? shelves.preLowGain : shelves.postLowGain;
+                auto& high = fitPre ? shelves.preHighGain : shelves.postHighGain;
+                low = gains[i / numGains];
+                high = gains[i % numGains];
+
+                // the curve has to cover everything the pre shelves can produce
+                auto pre = dry;
+                applyShelves(pre, sampleRate, shelves.preLowGain, shelves.preHighGain);
+                float range = 1.0e-3f;
+                for(auto x : pre)
+                    range = juce::jmax(range, std::abs(x));
+
+                candidates[(size_t)i] = fitPolynomial(dry, wet, sampleRate, order, range, shelves);
+            });
+
+            for(const auto& candidate : candidates)
+            {
+                if(candidate.errorToSignal < best.errorToSignal)
+                    best = candidate;
+            }
+
+            std::cout << "Pass " << pass + 1 << ": pre " << best.preLowGain << "/" << best.preHighGain
+                      << " dB, post " << best.postLowGain << "/" << best.postHighGain
+                      << " dB, error to signal " << best.errorToSignal << std::endl;
+        }
+
+        auto pre = dry;
+        applyShelves(pre, sampleRate, best.preLowGain, best.preHighGain);
+        inputRange = 1.0e-3f;
+        for(auto x : pre)
+            inputRange = juce::jmax(inputRange, std::abs(x));
+
+        return best;
+    }
+
+    //==============================================================================
+    // Truncated BPTT over fixed length segments, a batch of segments per Adam step with the
+    // segments split across the pool. The loss is the error-to-signal ratio, so the learning rate
+    // doesn't depend on the recording's level.
+    Weights trainGru(const std::vector<float>& dry, const std::vector<float>& wet, int epochs, float learningRate,
+                     bool skip, juce::ThreadPool& pool)
+    {
+        const auto numThreads = juce::jmax(1, pool.getNumThreads());
+        const auto totalLength = (int)dry.size();
+
+        // the last stretch is held back for validation
+        const auto validationLength = juce::jmin(maxValidationSamples, totalLength / 10);
+        const auto trainingLength = totalLength - validationLength;
+
+        std::vector<int> segmentStarts;
+        for(int start = 0; start + warmUpLength + segmentLength <= trainingLength; start += segmentLength)
+            segmentStarts.push_back(start);
+
+        if(segmentStarts.empty() || validationLength <= warmUpLength)
+        {
+            juce::ConsoleApplication::fail("The recordings are too short to train on");
+        }
+
+        double wetPower = 0;
+        for(auto y : wet)
+            wetPower += (double)y * y;
+        wetPower = juce::jmax(1.0e-12, wetPower / (double)wet.size());
+
+        const auto* validationDry = dry.data() + trainingLength;
+        const auto* validationWet = wet.data() + trainingLength;
+
+        std::mt19937 rng(0x5e47);
+
+        Weights weights;
+        weights.randomise(rng);
+
+        Weights best = weights;
+        double bestError = std::numeric_limits<double>::max();
+
+        GruAdam<NeuralShaper::hiddenSize> adam;
+
+        const auto segmentsPerBatch = numThreads * segmentsPerJob;
+        std::vector<Trainer> trainers((size_t)numThreads);
+        std::vector<Weights, Eigen::aligned_allocator<Weights>> gradients((size_t)numThreads);
+        std::vector<double> errors((size_t)numThreads);
+
+        for(int epoch = 1; epoch <= epochs; ++epoch)
+        {
+            std::shuffle(segmentStarts.begin(), segmentStarts.end(), rng);
+            double trainingError = 0;
+
+            for(size_t first = 0; first < segmentStarts.size(); first += (size_t)segmentsPerBatch)
+            {
+                const auto count = (int)juce::jmin((size_t)segmentsPerBatch, segmentStarts.size() - first);
+
+                parallelFor(pool, numThreads, [&](int job)
+                {
+                    auto& g = gradients[(size_t)job];
+                    g.setZero();
+                    errors[(size_t)job] = 0;
+
+                    for(int s = job; s < count; s += numThreads)
+                    {
+                        const auto start = segmentStarts[first + (size_t)s];
+                        errors[(size_t)job] += trainers[(size_t)job].accumulateGradients(weights, dry.data() + start, wet.data() + start,
+                                                                                         warmUpLength + segmentLength, warmUpLength, skip, g);
+                    }
+                });
+
+                Weights total = gradients[0];
+                for(size_t j = 1; j < gradients.size(); ++j)
+                    total += gradients[j];
+
+                const auto scale = (float)(1.0 / ((double)count * segmentLength * wetPower));
+                total.forEachBlock([scale](float* p, int size)
+                {
+                    for(int i = 0; i < size; ++i)
+                        p[i] *= scale;
+                });
+
+                adam.step(weights, total, learningRate);
+
+                for(auto e : errors)
+                    trainingError += e;
+            }
+
+            const auto validationError = Trainer::evaluate(weights, validationDry, validationWet, validationLength, skip)
+                                       / ((double)validationLength * wetPower);
+
+            if(validationError < bestError)
+            {
+                bestError = validationError;
+                best = weights;
+            }
+
+            std::cout << "Epoch " << epoch
+                      << "  training ESR " << trainingError / ((double)segmentStarts.size() * segmentLength * wetPower)
+                      << "  validation ESR " << validationError << std::endl;
+        }
+
+        std::cout << "Best validation ESR " << bestError << std::endl;
+        return best;
+    }
+}
+
+void CaptureTool::run(const juce::ArgumentList& args)
+{
+    auto dryFile = args.getExistingFileForOption("--capture");
+    auto wetFile = args.getExistingFileForOption("--wet");
+
+    auto outOption = args.getValueForOption("--out");
+    if(outOption.isEmpty())
+    {
+        juce::ConsoleApplication::fail("Expected --out <capture.bin>");
+    }
+    auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile(outOption.unquoted());
+
+    const auto type = args.containsOption("--type") ? args.getValueForOption("--type") : juce::String("gru");
+    if(type != "gru" && type != "curve")
+    {
+        juce::ConsoleApplication::fail("--type must be gru or curve");
+    }
+
+    auto getIntOption = [&args](const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    const auto numThreads = juce::jmax(1, getIntOption("--threads", juce::SystemStats::getNumCpus()));
+    const auto epochs = juce::jmax(1, getIntOption("--epochs", 100));
+    const auto order = juce::jlimit(1, 31, getIntOption("--order", 9));
+    const auto learningRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getFloatValue() : 0.005f;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    double drySampleRate = 0, wetSampleRate = 0;
+    auto dry = readMono(formats, dryFile, drySampleRate);
+    auto wet = readMono(formats, wetFile, wetSampleRate);
+
+    if(drySampleRate != wetSampleRate)
+    {
+        juce::ConsoleApplication::fail("The test signal and the recording have different sample rates");
+    }
+
+    bool inverted = false;
+    const auto latency = findLatency(dry, wet, (int)(maxLatencySeconds * drySampleRate), inverted);
+
+    std::cout << "Recording lags the test signal by " << latency << " samples ("
+              << latency / drySampleRate * 1000.0 << " ms)" << (inverted ? ", polarity inverted" : "") << std::endl;
+
+    // the overlapping part, with the recording shifted into line
+    const auto dryStart = juce::jmax(0, -latency);
+    const auto wetStart = juce::jmax(0, latency);
+    const auto length = juce::jmin(dry.getNumSamples() - dryStart, wet.getNumSamples() - wetStart);
+
+    if(length <= curveSettleSamples + warmUpLength + segmentLength)
+    {
+        juce::ConsoleApplication::fail("The recordings don't overlap for long enough");
+    }
+
+    std::vector<float> alignedDry(dry.getReadPointer(0, dryStart), dry.getReadPointer(0, dryStart) + length);
+    std::vector<float> alignedWet(wet.getReadPointer(0, wetStart), wet.getReadPointer(0, wetStart) + length);
+
+    if(inverted)
+    {
+        for(auto& y : alignedWet)
+            y = -y;
+    }
+
+    juce::ThreadPool pool(numThreads);
+    std::vector<char> modelData;
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    if(type == "curve")
+    {
+        const auto curveLength = (size_t)juce::jmin(length, maxCurveSamples);
+        std::vector<float> curveDry(alignedDry.begin(), alignedDry.begin() + (long)curveLength);
+        std::vector<float> curveWet(alignedWet.begin(), alignedWet.begin() + (long)curveLength);
+
+        float inputRange = 1;
+        auto fit = fitCurve(curveDry, curveWet, drySampleRate, order, inputRange, pool);
+
+        Curve curve;
+        curve.inputRange = inputRange;
+        curve.preLowGain = fit.preLowGain;
+        curve.preHighGain = fit.preHighGain;
+        curve.postLowGain = fit.postLowGain;
+        curve.postHighGain = fit.postHighGain;
+        curve.coefficients = fit.coefficients;
+
+        modelData = curve.saveWeights();
+    }
+    else
+    {
+        auto weights = trainGru(alignedDry, alignedWet, epochs, learningRate, true, pool);
+
+        auto model = std::make_unique<NeuralShaper::Model>();
+        model->inputWeights = weights.inputWeights;
+        model->inputBias = weights.inputBias;
+        model->hiddenBias = weights.hiddenBias;
+        model->hiddenWeights = weights.hiddenWeights;
+        model->outputWeights = weights.outputWeights;
+        model->outputBias = weights.outputBias;
+        model->skip = true;
+
+        modelData = model->saveWeights();
+    }
+
+    if(!outFile.replaceWithData(modelData.data(), modelData.size()))
+    {
+        juce::ConsoleApplication::fail("Couldn't write " + outFile.getFullPathName());
+    }
+
+    std::cout << std::endl
+              << "Fitting took " << (juce::Time::getMillisecondCounterHiRes() - start) * 0.001 << " s" << std::endl
+              << "Capture in:   " << outFile.getFullPathName() << std::endl;
+}
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    CaptureTool.h
+    Created: 19 Oct 2026 9:48:10pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Fits the neural amp mode to a piece of hardware from a test signal and a recording of the unit
+// playing it back. The result loads from the plugin's menu (Load amp capture...) and reproduces
+// the unit with the drive knob at 0dB.
+namespace CaptureTool
+{
+    // --capture <dry.wav> --wet <recorded.wav> --out <capture.bin> [--type gru|curve]
+    //           [--threads <n>] [--epochs <n>] [--rate <r>] [--order <n>]
+    void run(const juce::ArgumentList& args);
+}
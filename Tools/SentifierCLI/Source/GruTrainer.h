@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    GruTrainer.h
+    Created: 19 Oct 2026 9:48:10pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../../../Source/NeuralNetwork.h"
+#include <array>
+#include <random>
+
+// Truncated backpropagation through time for the same 1 x H GRU NeuralShaper plays back, with the
+// gates laid out as reset, update, new like PyTorch. Only depends on Eigen so the capture tool can
+// run one of these per thread.
+template <int H>
+struct GruWeights
+{
+    using GateVector = Eigen::Matrix<float, 3 * H, 1>;
+    using GateMatrix = Eigen::Matrix<float, 3 * H, H>;
+    using HiddenVector = Eigen::Matrix<float, H, 1>;
+
+    GateVector inputWeights, inputBias, hiddenBias;
+    GateMatrix hiddenWeights;
+    HiddenVector outputWeights;
+    float outputBias {0};
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    void setZero()
+    {
+        inputWeights.setZero(); inputBias.setZero(); hiddenBias.setZero();
+        hiddenWeights.setZero(); outputWeights.setZero();
+        outputBias = 0;
+    }
+
+    // PyTorch's default, uniform in +-1/sqrt(H)
+    void randomise(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.f / std::sqrt((float)H), 1.f / std::sqrt((float)H));
+        auto fill = [&](auto& m) { m = m.NullaryExpr(m.rows(), m.cols(), [&]() { return dist(rng); }); };
+
+        fill(inputWeights); fill(inputBias); fill(hiddenBias);
+        fill(hiddenWeights); fill(outputWeights);
+        outputBias = 0;
+    }
+
+    GruWeights& operator+=(const GruWeights& other)
+    {
+        inputWeights += other.inputWeights; inputBias += other.inputBias; hiddenBias += other.hiddenBias;
+        hiddenWeights += other.hiddenWeights; outputWeights += other.outputWeights;
+        outputBias += other.outputBias;
+        return *this;
+    }
+
+    // visits every parameter block as a flat array, in a fixed order
+    template <typename Function>
+    void forEachBlock(Function&& f)
+    {
+        f(inputWeights.data(), (int)inputWeights.size());
+        f(inputBias.data(), (int)inputBias.size());
+        f(hiddenBias.data(), (int)hiddenBias.size());
+        f(hiddenWeights.data(), (int)hiddenWeights.size());
+        f(outputWeights.data(), (int)outputWeights.size());
+        f(&outputBias, 1);
+    }
+};
+
+template <int H>
+class GruTrainer
+{
+public:
+    using Weights = GruWeights<H>;
+    using HiddenVector = typename Weights::HiddenVector;
+
+    // Runs one segment forward, warming the state up on the first warmUp samples without scoring
+    // them, then accumulates the gradient of the summed squared error into gradients. Returns that
+    // error. skip adds the input straight to the output, as in NeuralShaper.
+    double accumulateGradients(const Weights& w, const float* input, const float* target,
+                               int length, int warmUp, bool skip, Weights& gradients)
+    {
+        if((int)steps.size() < length)
+            steps.resize((size_t)length);
+
+        HiddenVector h = HiddenVector::Zero();
+        double error = 0;
+
+        for(int t = 0; t < length; ++t)
+        {
+            auto& s = steps[(size_t)t];
+            s.previous = h;
+
+            const typename Weights::GateVector hidden = w.hiddenWeights * h + w.hiddenBias;
+            const typename Weights::GateVector gates = w.inputWeights * input[t] + w.inputBias;
+
+            s.hiddenNew = hidden.template tail<H>();
+            s.reset = sigmoid(gates.template head<H>() + hidden.template head<H>());
+            s.update = sigmoid(gates.template segment<H>(H) + hidden.template segment<H>(H));
+            s.candidate = (gates.template tail<H>().array() + s.reset.array() * s.hiddenNew.array()).tanh();
+
+            h = s.candidate + s.update.cwiseProduct(h - s.candidate);
+            s.state = h;
+
+            const float y = w.outputWeights.dot(h) + w.outputBias + (skip ? input[t] : 0.f);
+            s.outputError = t >= warmUp ? y - target[t] : 0.f;
+            error += (double)s.outputError * s.outputError;
+        }
+
+        // and back again
+        HiddenVector dh = HiddenVector::Zero();
+
+        for(int t = length - 1; t >= 0; --t)
+        {
+            const auto& s = steps[(size_t)t];
+            const float dy = 2.f * s.outputError;
+
+            gradients.outputWeights += dy * s.state;
+            gradients.outputBias += dy;
+            dh += dy * w.outputWeights;
+
+            const HiddenVector dn = dh.cwiseProduct(HiddenVector::Ones() - s.update);
+            const HiddenVector dz = dh.cwiseProduct(s.previous - s.candidate);
+
+            const HiddenVector dnPre = dn.cwiseProduct(HiddenVector::Ones() - s.candidate.cwiseAbs2());
+            const HiddenVector dr = dnPre.cwiseProduct(s.hiddenNew);
+            const HiddenVector dzPre = dz.array() * s.update.array() * (1.f - s.update.array());
+            const HiddenVector drPre = dr.array() * s.reset.array() * (1.f - s.reset.array());
+
+            typename Weights::GateVector dInputGates, dHiddenGates;
+            dInputGates << drPre, dzPre, dnPre;
+            dHiddenGates << drPre, dzPre, dnPre.cwiseProduct(s.reset);
+
+            gradients.inputWeights += dInputGates * input[t];
+            gradients.inputBias += dInputGates;
+            gradients.hiddenBias += dHiddenGates;
+            gradients.hiddenWeights.noalias() += dHiddenGates * s.previous.transpose();
+
+            dh = dh.cwiseProduct(s.update) + w.hiddenWeights.transpose() * dHiddenGates;
+        }
+
+        return error;
+    }
+
+    // error of a full pass over a signal, for validation
+    static double evaluate(const Weights& w, const float* input, const float* target, int length, bool skip)
+    {
+        HiddenVector h = HiddenVector::Zero();
+        double error = 0;
+
+        for(int t = 0; t < length; ++t)
+        {
+            const typename Weights::GateVector hidden = w.hiddenWeights * h + w.hiddenBias;
+            const typename Weights::GateVector gates = w.inputWeights * input[t] + w.inputBias;
+
+            const HiddenVector reset = sigmoid(gates.template head<H>() + hidden.template head<H>());
+            const HiddenVector update = sigmoid(gates.template segment<H>(H) + hidden.template segment<H>(H));
+            const HiddenVector candidate = (gates.template tail<H>().array() + reset.array() * hidden.template tail<H>().array()).tanh();
+
+            h = candidate + update.cwiseProduct(h - candidate);
+
+            const float e = w.outputWeights.dot(h) + w.outputBias + (skip ? input[t] : 0.f) - target[t];
+            error += (double)e * e;
+        }
+
+        return error;
+    }
+
+private:
+    struct Step
+    {
+        HiddenVector previous, state, reset, update, candidate, hiddenNew;
+        float outputError {0};
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    template <typename Derived>
+    static HiddenVector sigmoid(const Eigen::MatrixBase<Derived>& x)
+    {
+        return (1.f + (-x.array()).exp()).inverse().matrix();
+    }
+
+    std::vector<Step, Eigen::aligned_allocator<Step>> steps;
+};
+
+// Adam over a GruWeights parameter set
+template <int H>
+class GruAdam
+{
+public:
+    GruAdam()
+    {
+        m.setZero();
+        v.setZero();
+    }
+
+    void step(GruWeights<H>& weights, GruWeights<H>& gradients, float learningRate)
+    {
+        ++t;
+        const float correction = learningRate * std::sqrt(1.f - std::pow(beta2, (float)t)) / (1.f - std::pow(beta1, (float)t));
+
+        std::array<float*, 6> ms, vs, gs;
+        size_t n = 0;
+        m.forEachBlock([&](float* p, int) { ms[n++] = p; });
+        n = 0;
+        v.forEachBlock([&](float* p, int) { vs[n++] = p; });
+        n = 0;
+        gradients.forEachBlock([&](float* p, int) { gs[n++] = p; });
+
+        n = 0;
+        weights.forEachBlock([&](float* p, int size)
+        {
+            for(int i = 0; i < size; ++i)
+            {
+                const float g = gs[n][i];
+                ms[n][i] = beta1 * ms[n][i] + (1.f - beta1) * g;
+                vs[n][i] = beta2 * vs[n][i] + (1.f - beta2) * g * g;
+                p[i] -= correction * ms[n][i] / (std::sqrt(vs[n][i]) + epsilon);
+            }
+            ++n;
+        });
+    }
+
+private:
+    static constexpr float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1.0e-8f;
+
+    GruWeights<H> m, v;
+    int t = 0;
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    ImagePresetGenerator.cpp
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "ImagePresetGenerator.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/ImageAnalysisCache.h"
+#include "../../../Source/ImagePatchModel.h"
+
+namespace
+{
+    const juce::String imageWildcard {"*.jpg;*.jpeg;*.png;*.bmp;*.tif;*.tiff;*.webp"};
+    
+    struct ImageResult
+    {
+        bool analysed {false};
+        bool ok {false};
+        double milliseconds {0};
+        ImageFeatures features;
+    };
+    
+    void setParameter(juce::ValueTree& state, const juce::String& paramID, float value)
+    {
+        auto param = state.getChildWithProperty("id", paramID);
+        jassert(param.isValid());
+        param.setProperty("value", value, nullptr);
+    }
+    
+    void writePatchToState(juce::ValueTree& state, const ImagePatch& patch)
+    {
+        setParameter(state, "distortion mode", (float)patch.distortionMode);
+        setParameter(state, "drive", patch.drive);
+        setParameter(state, "mix", patch.mix);
+        setParameter(state, "lowCut Freq", patch.lowCutFreq);
+        setParameter(state, "highCut Freq", patch.highCutFreq);
+    }
+    
+    // only extracts the features, the patches are generated afterwards in one batch
+    class ImageJob : public juce::ThreadPoolJob
+    {
+    public:
+        ImageJob(const juce::File& imageToAnalyse,
+                 ImageAnalysisCache* sharedCache,
+                 ImageResult& resultToFill)
+        : juce::ThreadPoolJob(imageToAnalyse.getFileName()),
+          image(imageToAnalyse),
+          cache(sharedCache),
+          result(resultToFill)
+        {
+        }
+        
+        JobStatus runJob() override
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            
+            if(cache != nullptr)
+            {
+                result.features = cache->getOrAnalyse(image, analyser).features;
+            }
+            else
+            {
+                result.features = analyser.extractFeatures(image.getFullPathName().toStdString());
+            }
+            
+            result.analysed = result.features.hsv.analysedWidth > 0;
+            result.milliseconds = juce::Time::getMillisecondCounterHiRes() - start;
+            return jobHasFinished;
+        }
+        
+    private:
+        juce::File image;
+        ImageAnalysisCache* cache;
+        ImageResult& result;
+        ImageAnalyser analyser;
+    };
+}
+
+void ImagePresetGenerator::run(const juce::ArgumentList& args)
+{
+    auto imageFolder = args.getExistingFolderForOption("--images");
+    
+    auto outOption = args.getValueForOption("--out");
+    if(outOption.isEmpty())
+    {
+        juce::ConsoleApplication::fail("Expected --out <presetFolder>");
+    }
+    
+    auto presetFolder = juce::File::getCurrentWorkingDirectory().getChildFile(outOption.unquoted());
+    if(!presetFolder.createDirectory().wasOk())
+    {
+        juce::ConsoleApplication::fail("Couldn't create " + presetFolder.getFullPathName());
+    }
+    
+    auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                       : juce::SystemStats::getNumCpus();
+    numThreads = juce::jmax(1, numThreads);
+    
+    auto images = imageFolder.findChildFiles(juce::File::findFiles, true, imageWildcard);
+    if(images.isEmpty())
+    {
+        juce::ConsoleApplication::fail("No images found in " + imageFolder.getFullPathName());
+    }
+    
+    // presets mirror the image folder's tree and keep the image's full name (photos/a.jpg becomes
+    // photos/a.jpg.xml), so a.jpg and a.png get separate presets. The only clash left is names that
+    // differ only in case, which would overwrite each other on a case-insensitive disk.
+    std::vector<juce::File> presetFiles;
+    std::map<juce::String, int> presetIndices;
+    for(int i = 0; i < images.size(); ++i)
+    {
+        const auto relativePath = images[i].getRelativePathFrom(imageFolder);
+        presetFiles.push_back(presetFolder.getChildFile(relativePath + ".xml"));
+        
+        const auto inserted = presetIndices.emplace(relativePath.toLowerCase(), i);
+        if(!inserted.second)
+        {
+            juce::ConsoleApplication::fail("Both " + images[inserted.first->second].getFullPathName() + " and "
+                                           + images[i].getFullPathName() + " would be written to "
+                                           + presetFiles.back().getFullPathName());
+        }
+    }
+    
+    // images are processed one per core, so opencv's own tile threading would only oversubscribe
+    cv::setNumThreads(1);
+    
+    // a default processor gives us exactly the tree savePreset() writes
+    DistortionProjAudioProcessor processor;
+    auto templateState = processor.apvts.copyState();
+    
+    // the bundled weights unless --model points at a freshly trained file
+    std::unique_ptr<ImagePatchModel> patchModel;
+    if(args.containsOption("--model"))
+    {
+        juce::MemoryBlock weights;
+        auto modelFile = args.getExistingFileForOption("--model");
+        if(!modelFile.loadFileAsData(weights))
+        {
+            juce::ConsoleApplication::fail("Couldn't read " + modelFile.getFullPathName());
+        }
+        
+        patchModel = std::make_unique<ImagePatchModel>(weights.getData(), weights.getSize());
+        if(!patchModel->isLoaded())
+        {
+            juce::ConsoleApplication::fail(modelFile.getFullPathName() + " isn't a patch model for this build");
+        }
+    }
+    else
+    {
+        patchModel = std::make_unique<ImagePatchModel>();
+    }
+    
+    std::cout << (patchModel->isLoaded() ? "Using the patch model" : "No patch model, using the hue mapping") << std::endl;
+    
+    std::unique_ptr<juce::SharedResourcePointer<ImageAnalysisCache>> sharedCache;
+    ImageAnalysisCache* cache = nullptr;
+    if(args.containsOption("--cache"))
+    {
+        sharedCache = std::make_unique<juce::SharedResourcePointer<ImageAnalysisCache>>();
+        cache = &sharedCache->get();
+    }
+    
+    std::vector<ImageResult> results((size_t)images.size());
+    
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    
+    {
+        juce::ThreadPool pool(numThreads);
+        
+        for(int i = 0; i < images.size(); ++i)
+        {
+            pool.addJob(new ImageJob(images[i], cache, results[(size_t)i]), true);
+        }
+        
+        while(pool.getNumJobs() > 0)
+        {
+            juce::Thread::sleep(50);
+        }
+    }
+    
+    std::vector<ImageFeatures> analysedFeatures;
+    std::vector<size_t> analysedIndices;
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        if(results[i].analysed)
+        {
+            analysedFeatures.push_back(results[i].features);
+            analysedIndices.push_back(i);
+        }
+    }
+    
+    std::vector<ImagePatch> patches;
+    if(patchModel->isLoaded())
+    {
+        patches = patchModel->predictBatch(analysedFeatures);
+    }
+    else
+    {
+        ImageAnalyser analyser;
+        for(const auto& features : analysedFeatures)
+            patches.push_back(analyser.generateHuePatch(features));
+    }
+    
+    for(size_t n = 0; n < analysedIndices.size(); ++n)
+    {
+        const auto i = analysedIndices[n];
+        const auto& preset = presetFiles[i];
+        
+        auto state = templateState.createCopy();
+        writePatchToState(state, patches[n]);
+        
+        std::unique_ptr<juce::XmlElement> xml(state.createXml());
+        results[i].ok = xml != nullptr && preset.getParentDirectory().createDirectory().wasOk() && xml->writeTo(preset);
+    }
+    
+    const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    
+    int failures = 0;
+    double totalMs = 0, slowestMs = 0;
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        if(!results[i].ok)
+        {
+            ++failures;
+            std::cout << "Failed: " << images[(int)i].getFullPathName() << std::endl;
+        }
+        totalMs += results[i].milliseconds;
+        slowestMs = juce::jmax(slowestMs, results[i].milliseconds);
+    }
+    
+    const auto numImages = (int)results.size();
+    
+    std::cout << std::endl
+              << "Images:      " << numImages << " (" << failures << " failed)" << std::endl
+              << "Threads:     " << numThreads << std::endl
+              << "Wall time:   " << elapsed << " s" << std::endl
+              << "Throughput:  " << numImages / juce::jmax(elapsed, 1.0e-6) << " images/s" << std::endl
+              << "Per image:   " << totalMs / numImages << " ms mean, " << slowestMs << " ms slowest" << std::endl
+              << "Presets in:  " << presetFolder.getFullPathName() << std::endl;
+    
+    if(failures > 0)
+    {
+        juce::ConsoleApplication::fail(juce::String(failures) + " images could not be analysed", 1);
+    }
+}
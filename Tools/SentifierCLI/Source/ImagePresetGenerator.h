@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    ImagePresetGenerator.h
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ImagePresetGenerator
+{
+    // --images <imageFolder> --out <presetFolder> [--threads <n>] [--cache] [--model <weights.bin>]
+    void run(const juce::ArgumentList& args);
+}
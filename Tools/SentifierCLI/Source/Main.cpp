@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for a JUCE application.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchRenderer.h"
+#include "CaptureTool.h"
+#include "ImagePresetGenerator.h"
+#include "MicroBenchmark.h"
+#include "PatchModelTrainer.h"
+#include "RegressionSuite.h"
+#include "RenderTool.h"
+#include "ShaperBenchmark.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the plugin's processor and image code expect the message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::ConsoleApplication app;
+    
+    app.addHelpCommand("--help|-h", "Sentifier command line tools", true);
+    
+    app.addCommand({ "--images",
+                     "--images <imageFolder> --out <presetFolder> [--threads <n>] [--cache] [--model <weights.bin>]",
+                     "Generates one preset for every image in a folder",
+                     "Walks the image folder recursively, analyses every image in parallel and writes a preset "
+                     "XML per image in the same format as the plugin's savePreset(). Presets mirror the image folder's "
+                     "tree and keep the image's name, so photos/a.jpg becomes photos/a.jpg.xml. --cache reuses (and fills) "
+                     "the plugin's on-disk image analysis cache.",
+                     [](const juce::ArgumentList& args) { ImagePresetGenerator::run(args); } });
+    
+    app.addCommand({ "--train",
+                     "--train <datasetFolder> --out <weights.bin> [--epochs <n>] [--batch <n>] [--rate <r>] "
+                     "[--threads <n>] [--checkpoints <folder>] [--resume <checkpoint.ckpt>] [--cache]",
+                     "Trains the image-to-patch model",
+                     "Pairs every preset XML in the dataset folder with the image of the same name, extracts "
+                     "the image features in parallel and trains the patch model with mini-batch Adam. The "
+                     "weights from the epoch with the lowest validation loss are written to --out, every "
+                     "epoch is also written to --checkpoints if given, as weights (.bin) and as a full training "
+                     "checkpoint (.ckpt) with the Adam moments, step count and shuffling state. --resume "
+                     "continues from a .ckpt exactly where that run left off.",
+                     [](const juce::ArgumentList& args) { PatchModelTrainer::run(args); } });
+    
+    app.addCommand({ "--bench",
+                     "--bench [--filter <text>] [--blocks <n,n,...>] [--min-time <seconds>] [--repeats <n>] [--rate <hz>] "
+                     "[--csv <file>] [--json <file>]",
+                     "Times the DSP modules and processBlock()",
+                     "Measures ns per sample for every Clipper and Saturation type, every SVFilter type in each "
+                     "stereo mode, the cut filters at each slope, the WaveShaper, the LFOGenerator, the analyser's FFT at each order, the "
+                     "multiband engine with 2-5 bands run serially and in parallel, and the processor's processBlock() in every distortion mode, at block sizes from 16 to 4096. "
+                     "Each figure is the median of --repeats runs of at least --min-time seconds. --filter "
+                     "only runs benchmarks whose name contains the text, --csv and --json write the results.",
+                     [](const juce::ArgumentList& args) { MicroBenchmark::run(args); } });
+    
+    app.addCommand({ "--bench-shaper",
+                     "--bench-shaper [--seconds <n>] [--block <n>] [--rate <hz>]",
+                     "Measures the neural amp mode's CPU use",
+                     "Runs noise through the neural amp mode on one channel and reports the time per sample, "
+                     "real-time factor and share of a core. Fails if that share is over the mode's budget.",
+                     [](const juce::ArgumentList& args) { ShaperBenchmark::run(args); } });
+    
+    app.addCommand({ "--capture",
+                     "--capture <dry.wav> --wet <recorded.wav> --out <capture.bin> [--type gru|curve] "
+                     "[--threads <n>] [--epochs <n>] [--rate <r>] [--order <n>]",
+                     "Fits the neural amp mode to a hardware recording",
+                     "Aligns the recording with the test signal by FFT cross-correlation, then either trains the "
+                     "neural amp's GRU (--type gru, the default) or fits shelving EQ around a static polynomial "
+                     "curve (--type curve). Both write a capture the plugin loads from its menu.",
+                     [](const juce::ArgumentList& args) { CaptureTool::run(args); } });
+    
+    app.addCommand({ "--render",
+                     "--render <in.wav> --out <out.wav|flac> [--preset <preset.xml>] [--block <n>] [--vary-blocks] [--bits <n>]",
+                     "Renders an audio file through the plugin",
+                     "Streams the file through the plugin's processor a block at a time and writes the result in "
+                     "the format of --out's extension. --preset loads a preset XML first, --vary-blocks uses a "
+                     "random block size up to --block for every block. Reports the real-time factor.",
+                     [](const juce::ArgumentList& args) { RenderTool::run(args); } });
+    
+    app.addCommand({ "--batch",
+                     "--batch <inputFolder> --out <outputFolder> [--preset <preset.xml>] [--threads <n>] [--block <n>] "
+                     "[--format wav|flac|aiff] [--bits <n>]",
+                     "Renders a folder of audio files through the plugin in parallel",
+                     "Runs one processor per worker thread. Files are dealt out largest first and idle workers "
+                     "steal from the busiest queue. Wav and aiff inputs are memory mapped, and output is written "
+                     "a block at a time, mirroring the input folder's layout with the output extension added to "
+                     "each file's name (take.flac becomes take.flac.wav). Reports per-file timing and the "
+                     "aggregate throughput.",
+                     [](const juce::ArgumentList& args) { BatchRenderer::run(args); } });
+    
+    app.addCommand({ "--regress",
+                     "--regress [referenceFolder] [--update] [--tolerance <dBFS>]",
+                     "Checks the processor's output against reference renders",
+                     "Renders a sine sweep, noise and impulses through every distortion mode at several drive and "
+                     "mix settings and compares each against the 32 bit float wav of the same name in the "
+                     "reference folder, by default the references in Tools/SentifierCLI/regression that "
+                     "make_references.sh renders from the processor before the DSP optimisations. Samples "
+                     "must match bit for bit unless --tolerance gives the largest allowed peak difference. "
+                     "--update writes the references instead. Fails if any case differs, or, when built with "
+                     "SENTIFIER_RT_SAFETY_CHECKS, if processBlock() allocated or took a lock.",
+                     [](const juce::ArgumentList& args) { RegressionSuite::run(args); } });
+    
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,462 @@
+/*
+  ==============================================================================
+
+    MicroBenchmark.cpp
+    Created: 20 Oct 2026 4:55:12pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "MicroBenchmark.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+namespace
+{
+    using Clipper = viator_dsp::Clipper<float>;
+    using Saturation = viator_dsp::Saturation<float>;
+    using SVFilter = viator_dsp::SVFilter<float>;
+
+    // Made once per block size. samplesPerCall is what one call of process() works through,
+    // per channel, and is what the time gets divided by.
+    struct Runner
+    {
+        std::function<void()> process;
+        int samplesPerCall {0};
+    };
+
+    struct Benchmark
+    {
+        juce::String name;
+        bool usesBlockSize {true};
+        std::function<Runner(double sampleRate, int blockSize)> create;
+    };
+
+    struct Measurement
+    {
+        juce::String name;
+        int blockSize {0};
+        double nsPerSample {0};    // median of the repeats
+        double minNsPerSample {0};
+        double nsPerCall {0};
+        juce::int64 iterations {0};
+    };
+
+    // The modules process in place, so each call starts from a fresh copy of the same noise,
+    // otherwise filters with gain would run away and clippers would settle on a constant. The
+    // copy is part of every measurement and is small next to the processing.
+    struct StereoNoise
+    {
+        StereoNoise(int blockSize) : source(2, blockSize), buffer(2, blockSize)
+        {
+            juce::Random random(0x5e47);
+            for(int ch = 0; ch < 2; ++ch)
+                for(int i = 0; i < blockSize; ++i)
+                    source.setSample(ch, i, 0.5f * (random.nextFloat() * 2.f - 1.f));
+        }
+
+        juce::dsp::ProcessContextReplacing<float> refresh()
+        {
+            for(int ch = 0; ch < 2; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, source.getNumSamples());
+
+            block = juce::dsp::AudioBlock<float>(buffer);
+            return juce::dsp::ProcessContextReplacing<float>(block);
+        }
+
+        juce::AudioBuffer<float> source, buffer;
+        juce::dsp::AudioBlock<float> block;
+    };
+
+    juce::dsp::ProcessSpec makeSpec(double sampleRate, int blockSize)
+    {
+        return { sampleRate, (juce::uint32)blockSize, 2 };
+    }
+
+    template <typename Module>
+    Runner makeModuleRunner(std::shared_ptr<Module> module, int blockSize)
+    {
+        auto noise = std::make_shared<StereoNoise>(blockSize);
+        return { [module, noise] { module->process(noise->refresh()); }, blockSize };
+    }
+
+    void setParameter(DistortionProjAudioProcessor& processor, const juce::String& paramID, float value)
+    {
+        auto* param = processor.apvts.getParameter(paramID);
+        jassert(param != nullptr);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    std::vector<Benchmark> createBenchmarks()
+    {
+        std::vector<Benchmark> benchmarks;
+
+        const std::pair<const char*, Clipper::ClipType> clipTypes[]
+        {
+            { "hard", Clipper::ClipType::kHard }, { "soft", Clipper::ClipType::kSoft }, { "diode", Clipper::ClipType::kDiode }
+        };
+
+        for(auto [typeName, type] : clipTypes)
+        {
+            benchmarks.push_back({ juce::String("Clipper/") + typeName, true, [type = type](double sampleRate, int blockSize)
+            {
+                auto clipper = std::make_shared<Clipper>();
+                clipper->prepare(makeSpec(sampleRate, blockSize));
+                clipper->setClipperType(type);
+                clipper->setParameter(Clipper::ParameterId::kPreamp, 12.f);
+                clipper->setParameter(Clipper::ParameterId::kMix, 100.f);
+                return makeModuleRunner(clipper, blockSize);
+            } });
+        }
+
+        const std::pair<const char*, Saturation::DistortionType> saturationTypes[]
+        {
+            { "hard", Saturation::DistortionType::kHard }, { "saturation", Saturation::DistortionType::kSaturation },
+            { "tube", Saturation::DistortionType::kTube }, { "tape", Saturation::DistortionType::kTape }
+        };
+
+        for(auto [typeName, type] : saturationTypes)
+        {
+            benchmarks.push_back({ juce::String("Saturation/") + typeName, true, [type = type](double sampleRate, int blockSize)
+            {
+                auto saturation = std::make_shared<Saturation>();
+                saturation->prepare(makeSpec(sampleRate, blockSize));
+                saturation->setDistortionType(type);
+                saturation->setParameter(Saturation::ParameterId::kPreamp, 12.f);
+                saturation->setParameter(Saturation::ParameterId::kMix, 100.f);
+                return makeModuleRunner(saturation, blockSize);
+            } });
+        }
+
+        const std::pair<const char*, SVFilter::FilterType> filterTypes[]
+        {
+            { "lowShelf", SVFilter::kLowShelf }, { "highPass", SVFilter::kHighPass }, { "bandShelf", SVFilter::kBandShelf },
+            { "lowPass", SVFilter::kLowPass }, { "highShelf", SVFilter::kHighShelf }
+        };
+
+        const std::pair<const char*, SVFilter::StereoId> stereoIds[]
+        {
+            { "stereo", SVFilter::StereoId::kStereo }, { "mids", SVFilter::StereoId::kMids }, { "sides", SVFilter::StereoId::kSides }
+        };
+
+        for(auto [typeName, type] : filterTypes)
+        {
+            for(auto [stereoName, stereo] : stereoIds)
+            {
+                benchmarks.push_back({ juce::String("SVFilter/") + typeName + "/" + stereoName, true,
+                                       [type = type, stereo = stereo](double sampleRate, int blockSize)
+                {
+                    // a cutoff and gain that keep process() from taking any of its early outs
+                    auto filter = std::make_shared<SVFilter>();
+                    filter->prepare(makeSpec(sampleRate, blockSize));
+                    filter->setStereoType(stereo);
+                    filter->setParameter(SVFilter::ParameterId::kType, type);
+                    filter->setParameter(SVFilter::ParameterId::kQType, SVFilter::kParametric);
+                    filter->setParameter(SVFilter::ParameterId::kCutoff, 1000.f);
+                    filter->setParameter(SVFilter::ParameterId::kQ, 0.3f);
+                    filter->setParameter(SVFilter::ParameterId::kGain, 6.f);
+                    return makeModuleRunner(filter, blockSize);
+                } });
+            }
+        }
+
+        for(int slope = CutFilter::slope6; slope <= CutFilter::slope48; ++slope)
+        {
+            const auto name = juce::String("CutFilter/") + juce::String(CutFilter::getOrder((CutFilter::Slope)slope) * 6) + "dB";
+
+            benchmarks.push_back({ name, true, [slope](double sampleRate, int blockSize)
+            {
+                auto filter = std::make_shared<CutFilter>(CutFilter::highpass);
+                filter->prepare(makeSpec(sampleRate, blockSize));
+                filter->setParameters(1000.f, (CutFilter::Slope)slope);
+
+                auto noise = std::make_shared<StereoNoise>(blockSize);
+                return Runner { [filter, noise] { filter->process(noise->refresh().getOutputBlock()); }, blockSize };
+            } });
+        }
+
+        benchmarks.push_back({ "WaveShaper", true, [](double sampleRate, int blockSize)
+        {
+            auto shaper = std::make_shared<viator_dsp::WaveShaper>();
+            shaper->prepare(makeSpec(sampleRate, blockSize));
+            shaper->setParameter(viator_dsp::WaveShaper::ParameterId::kPreamp, 6.f);
+            return makeModuleRunner(shaper, blockSize);
+        } });
+
+        const std::pair<const char*, viator_dsp::LFOGenerator::WaveType> waveTypes[]
+        {
+            { "sine", viator_dsp::LFOGenerator::WaveType::kSine }, { "saw", viator_dsp::LFOGenerator::WaveType::kSaw },
+            { "square", viator_dsp::LFOGenerator::WaveType::kSquare }
+        };
+
+        for(auto [typeName, type] : waveTypes)
+        {
+            benchmarks.push_back({ juce::String("LFOGenerator/") + typeName, true, [type = type](double sampleRate, int blockSize)
+            {
+                // the generator only has a per sample call, driven here one mono block at a time
+                auto lfo = std::make_shared<viator_dsp::LFOGenerator>();
+                lfo->prepare(makeSpec(sampleRate, blockSize));
+                lfo->setWaveType(type);
+                lfo->setParameter(viator_dsp::LFOGenerator::ParameterId::kFrequency, 5.f);
+
+                auto output = std::make_shared<std::vector<float>>((size_t)blockSize);
+                return Runner { [lfo, output]
+                {
+                    for(auto& sample : *output)
+                        sample = lfo->processSample(0.f);
+                }, blockSize };
+            } });
+        }
+
+        const std::pair<const char*, FFTOrder> fftOrders[]
+        {
+            { "2048", FFTOrder::order2048 }, { "4096", FFTOrder::order4096 }, { "8192", FFTOrder::order8192 }
+        };
+
+        for(auto [orderName, order] : fftOrders)
+        {
+            benchmarks.push_back({ juce::String("AnalyserFFT/") + orderName, false, [order = order](double, int)
+            {
+                // the editor's path: window, transform, normalise, convert to dB and through the fifo
+                auto generator = std::make_shared<FFTDataGenerator<std::vector<float>>>();
+                generator->changeOrder(order);
+
+                const auto fftSize = generator->getFFTSize();
+                auto audio = std::make_shared<juce::AudioBuffer<float>>(1, fftSize);
+                juce::Random random(0x5e47);
+                for(int i = 0; i < fftSize; ++i)
+                    audio->setSample(0, i, random.nextFloat() * 2.f - 1.f);
+
+                auto fftData = std::make_shared<std::vector<float>>();
+                return Runner { [generator, audio, fftData]
+                {
+                    generator->produceFFTDataForRendering(*audio, -48.f);
+                    generator->getFFTData(*fftData);
+                }, fftSize };
+            } });
+        }
+
+        // The multiband engine on its own at 4x the rate, as it runs at full quality, with the
+        // bands distorted on one thread and across the worker pool. The block size where the
+        // parallel time per sample drops below the serial one is the break-even point
+        // RealtimeWorkerPool::setMinSamplesForParallel() should use.
+        auto workerPool = std::make_shared<RealtimeWorkerPool>(juce::jlimit(0, MultibandDistortion::maxBands - 1,
+                                                                            juce::SystemStats::getNumCpus() - 1));
+
+        for(int numBands = 2; numBands <= MultibandDistortion::maxBands; ++numBands)
+        {
+            for(auto parallel : { false, true })
+            {
+                const auto name = juce::String("Multiband/") + (parallel ? "parallel/" : "serial/") + juce::String(numBands) + "bands";
+
+                benchmarks.push_back({ name, true, [numBands, parallel, workerPool](double sampleRate, int blockSize)
+                {
+                    auto multiband = std::make_shared<MultibandDistortion>();
+                    multiband->prepare(makeSpec(sampleRate * 4.0, blockSize));
+
+                    // every block counts, so the pool doesn't fall back to serial below its threshold
+                    workerPool->setMinSamplesForParallel(0);
+                    multiband->setWorkerPool(parallel ? workerPool.get() : nullptr);
+
+                    MultibandDistortion::Settings settings;
+                    settings.numBands = numBands;
+                    settings.drive.fill(10.f);
+                    settings.mix.fill(100.f);
+
+                    auto noise = std::make_shared<StereoNoise>(blockSize);
+                    return Runner { [multiband, noise, settings] { multiband->process(noise->refresh(), settings, 3); }, blockSize };
+                } });
+            }
+        }
+
+        juce::StringArray modeNames;
+        {
+            DistortionProjAudioProcessor processor;
+            if(auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(processor.apvts.getParameter("distortion mode")))
+                modeNames = modeParam->choices;
+        }
+        modeNames.add("Neural Amp");
+
+        for(int mode = 0; mode < modeNames.size(); ++mode)
+        {
+            benchmarks.push_back({ "processBlock/" + modeNames[mode].removeCharacters(" "), true, [mode](double sampleRate, int blockSize)
+            {
+                auto processor = std::make_shared<DistortionProjAudioProcessor>();
+                if(mode == ChainSettings::neuralAmpMode)
+                    setParameter(*processor, "neural amp", 1.f);
+                else
+                    setParameter(*processor, "distortion mode", (float)mode);
+                setParameter(*processor, "drive", 10.f);
+
+                processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+                processor->prepareToPlay(sampleRate, blockSize);
+
+                auto noise = std::make_shared<StereoNoise>(blockSize);
+                auto midi = std::make_shared<juce::MidiBuffer>();
+                return Runner { [processor, noise, midi]
+                {
+                    noise->refresh();
+                    processor->processBlock(noise->buffer, *midi);
+                }, blockSize };
+            } });
+        }
+
+        return benchmarks;
+    }
+
+    // runs process() in batches until minSeconds have passed, then takes the best of the batch
+    // timings as one repeat; the median of the repeats is what gets reported
+    Measurement measure(const juce::String& name, int blockSize, const Runner& runner, double minSeconds, int repeats)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        // warm the caches and any lazily built tables
+        for(int i = 0; i < 3; ++i)
+            runner.process();
+
+        std::vector<double> nsPerSample;
+        juce::int64 iterations = 0;
+        double totalSeconds = 0;
+
+        for(int r = 0; r < repeats; ++r)
+        {
+            juce::int64 count = 0;
+            const auto start = juce::Time::getHighResolutionTicks();
+            double elapsed = 0;
+
+            do
+            {
+                for(int i = 0; i < 16; ++i)
+                    runner.process();
+
+                count += 16;
+                elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            }
+            while(elapsed < minSeconds);
+
+            nsPerSample.push_back(elapsed * 1.0e9 / ((double)count * runner.samplesPerCall));
+            iterations += count;
+            totalSeconds += elapsed;
+        }
+
+        std::sort(nsPerSample.begin(), nsPerSample.end());
+
+        Measurement m;
+        m.name = name;
+        m.blockSize = blockSize;
+        m.nsPerSample = nsPerSample[nsPerSample.size() / 2];
+        m.minNsPerSample = nsPerSample.front();
+        m.nsPerCall = totalSeconds * 1.0e9 / (double)iterations;
+        m.iterations = iterations;
+        return m;
+    }
+
+    bool writeCsv(const juce::File& file, const std::vector<Measurement>& results)
+    {
+        juce::String csv = "name,block_size,ns_per_sample,min_ns_per_sample,ns_per_call,iterations\n";
+        for(const auto& m : results)
+        {
+            csv << m.name << "," << m.blockSize << "," << m.nsPerSample << "," << m.minNsPerSample << ","
+                << m.nsPerCall << "," << m.iterations << "\n";
+        }
+        return file.replaceWithText(csv);
+    }
+
+    bool writeJson(const juce::File& file, const std::vector<Measurement>& results, double sampleRate)
+    {
+        juce::Array<juce::var> entries;
+        for(const auto& m : results)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("name", m.name);
+            entry->setProperty("blockSize", m.blockSize);
+            entry->setProperty("nsPerSample", m.nsPerSample);
+            entry->setProperty("minNsPerSample", m.minNsPerSample);
+            entry->setProperty("nsPerCall", m.nsPerCall);
+            entry->setProperty("iterations", m.iterations);
+            entries.add(juce::var(entry));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty("sampleRate", sampleRate);
+        root->setProperty("results", entries);
+
+        return file.replaceWithText(juce::JSON::toString(juce::var(root)));
+    }
+}
+
+void MicroBenchmark::run(const juce::ArgumentList& args)
+{
+    const auto filter = args.getValueForOption("--filter");
+    const auto sampleRate = args.containsOption("--rate") ? juce::jmax(8000.0, args.getValueForOption("--rate").getDoubleValue()) : 48000.0;
+    const auto minSeconds = args.containsOption("--min-time") ? juce::jmax(0.001, args.getValueForOption("--min-time").getDoubleValue()) : 0.02;
+    const auto repeats = args.containsOption("--repeats") ? juce::jmax(1, args.getValueForOption("--repeats").getIntValue()) : 5;
+
+    std::vector<int> blockSizes;
+    if(args.containsOption("--blocks"))
+    {
+        for(auto& size : juce::StringArray::fromTokens(args.getValueForOption("--blocks"), ",", {}))
+            if(size.getIntValue() > 0)
+                blockSizes.push_back(size.getIntValue());
+    }
+    else
+    {
+        for(int size = 16; size <= 4096; size *= 2)
+            blockSizes.push_back(size);
+    }
+
+    if(blockSizes.empty())
+    {
+        juce::ConsoleApplication::fail("--blocks needs at least one block size");
+    }
+
+    std::cout << juce::SystemStats::getCpuModel() << ", " << sampleRate << " Hz, stereo" << std::endl << std::endl;
+
+    std::vector<Measurement> results;
+
+    for(const auto& benchmark : createBenchmarks())
+    {
+        if(filter.isNotEmpty() && !benchmark.name.containsIgnoreCase(filter))
+            continue;
+
+        // the FFT works on its own fixed size, so it only runs once
+        const auto sizes = benchmark.usesBlockSize ? blockSizes : std::vector<int> { 0 };
+
+        for(auto blockSize : sizes)
+        {
+            const auto runner = benchmark.create(sampleRate, juce::jmax(1, blockSize));
+            results.push_back(measure(benchmark.name, runner.samplesPerCall, runner, minSeconds, repeats));
+
+            const auto& m = results.back();
+            std::cout << (m.name + "/" + juce::String(m.blockSize)).paddedRight(' ', 36)
+                      << juce::String(m.nsPerSample, 3).paddedLeft(' ', 12) << " ns/sample"
+                      << juce::String(m.nsPerCall / 1000.0, 3).paddedLeft(' ', 14) << " us/call" << std::endl;
+        }
+    }
+
+    if(results.empty())
+    {
+        juce::ConsoleApplication::fail("No benchmarks match " + filter);
+    }
+
+    if(args.containsOption("--csv"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--csv").unquoted());
+        if(!writeCsv(file, results))
+        {
+            juce::ConsoleApplication::fail("Couldn't write " + file.getFullPathName());
+        }
+    }
+
+    if(args.containsOption("--json"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--json").unquoted());
+        if(!writeJson(file, results, sampleRate))
+        {
+            juce::ConsoleApplication::fail("Couldn't write " + file.getFullPathName());
+        }
+    }
+}
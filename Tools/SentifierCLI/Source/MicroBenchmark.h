@@ -0,0 +1,24 @@
+/*
+  ==============================================================================
+
+    MicroBenchmark.h
+    Created: 20 Oct 2026 4:55:12pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Times every viator_dsp module the plugin uses, the analyser's FFT, the multiband engine (serial
+// and on the worker pool) and the whole processBlock() at block sizes from 16 to 4096, so a change to any of them can be checked for a slowdown. Results
+// are in ns per sample (ns per transform for the FFT) and can be written as CSV or JSON to diff
+// between runs.
+namespace MicroBenchmark
+{
+    // --bench [--filter <text>] [--blocks <n,n,...>] [--min-time <seconds>] [--repeats <n>]
+    //         [--rate <hz>] [--csv <file>] [--json <file>]
+    void run(const juce::ArgumentList& args);
+}
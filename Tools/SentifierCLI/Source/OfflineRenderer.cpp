@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 20 Oct 2026 9:14:36am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer()
+{
+    formats.registerBasicFormats();
+}
+
+bool OfflineRenderer::loadPreset(const juce::File& presetFile)
+{
+    auto xml = juce::XmlDocument::parse(presetFile);
+    if(xml == nullptr)
+    {
+        return false;
+    }
+
+    auto state = juce::ValueTree::fromXml(*xml);
+    if(!state.hasType(processor.apvts.state.getType()))
+    {
+        return false;
+    }
+
+    setState(state);
+    return true;
+}
+
+void OfflineRenderer::setState(const juce::ValueTree& state)
+{
+    processor.apvts.replaceState(state.createCopy());
+}
+
+std::unique_ptr<juce::AudioFormatReader> OfflineRenderer::createReader(const juce::File& file)
+{
+    if(auto* format = formats.findFormatForFileExtension(file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+        if(mapped != nullptr && mapped->mapEntireFile())
+        {
+            return mapped;
+        }
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+}
+
+OfflineRenderer::Result OfflineRenderer::render(const juce::File& inputFile, const juce::File& outputFile, const Settings& settings)
+{
+    auto reader = createReader(inputFile);
+    if(reader == nullptr)
+    {
+        Result result;
+        result.error = "Couldn't read " + inputFile.getFullPathName();
+        return result;
+    }
+
+    return render(*reader, outputFile, settings);
+}
+
+OfflineRenderer::Result OfflineRenderer::render(juce::AudioFormatReader& reader, const juce::File& outputFile, const Settings& settings)
+{
+    Result result;
+    const auto wallStart = juce::Time::getHighResolutionTicks();
+
+    auto* format = formats.findFormatForFileExtension(outputFile.getFileExtension());
+    if(format == nullptr)
+    {
+        result.error = "Unknown output format " + outputFile.getFileExtension();
+        return result;
+    }
+
+    const auto sampleRate = reader.sampleRate;
+    const auto numOutputChannels = juce::jlimit(1, 2, (int)reader.numChannels);
+
+    auto bitsPerSample = settings.bitsPerSample > 0 ? settings.bitsPerSample : (int)reader.bitsPerSample;
+    if(!format->getPossibleBitDepths().contains(bitsPerSample))
+    {
+        bitsPerSample = 24;
+    }
+
+    outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(outputFile.createOutputStream());
+    if(stream == nullptr)
+    {
+        result.error = "Couldn't create " + outputFile.getFullPathName();
+        return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int)numOutputChannels,
+                                                                            bitsPerSample, {}, 0));
+    if(writer == nullptr)
+    {
+        result.error = "Couldn't write " + format->getFormatName() + " at " + juce::String(bitsPerSample) + " bits";
+        return result;
+    }
+    stream.release(); // the writer owns it now
+
+    const auto blockSize = juce::jmax(1, settings.blockSize);
+
+    // the processor is always stereo, mono files are rendered on both sides and written back as mono
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // run past the end of the file for any latency and tail, and drop the latency from the start
+    const auto latency = (juce::int64)processor.getLatencySamples();
+    const auto tail = (juce::int64)std::ceil(processor.getTailLengthSeconds() * sampleRate);
+    const auto totalSamples = reader.lengthInSamples + latency + tail;
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    juce::int64 processingTicks = 0;
+    juce::int64 position = 0;
+
+    while(position < totalSamples)
+    {
+        auto numSamples = settings.varyBlockSize ? 1 + random.nextInt(blockSize) : blockSize;
+        numSamples = (int)juce::jmin((juce::int64)numSamples, totalSamples - position);
+
+        buffer.setSize(2, numSamples, false, false, true);
+
+        // reads past the end of the file come back as silence
+        reader.read(&buffer, 0, numSamples, position, true, true);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        processingTicks += juce::Time::getHighResolutionTicks() - start;
+
+        const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples, latency - position);
+        if(skip < numSamples && !writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+        {
+            result.error = "Write failed for " + outputFile.getFullPathName();
+            break;
+        }
+
+        position += numSamples;
+    }
+
+    result.load = processor.getLoadMonitor().getStats();
+
+    processor.releaseResources();
+    writer.reset();
+
+    result.ok = result.error.isEmpty();
+    result.numSamples = reader.lengthInSamples;
+    result.audioSeconds = (double)reader.lengthInSamples / sampleRate;
+    result.processingSeconds = juce::Time::highResolutionTicksToSeconds(processingTicks);
+    result.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - wallStart);
+
+    return result;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 20 Oct 2026 9:14:36am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+// Runs audio files through a DistortionProjAudioProcessor outside a host. Audio is streamed a
+// block at a time from the reader to the writer, so memory use doesn't grow with the file.
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        int blockSize {512};
+
+        // pick a random block size up to blockSize for every block, like some hosts do
+        bool varyBlockSize {false};
+
+        // 0 keeps the source's bit depth
+        int bitsPerSample {0};
+    };
+
+    struct Result
+    {
+        bool ok {false};
+        juce::String error;
+        juce::int64 numSamples {0};
+        double audioSeconds {0};
+        double processingSeconds {0}; // inside processBlock only
+        double wallSeconds {0};       // including reading and writing
+
+        // processBlock() time against each block's real-time deadline, so offline renders can
+        // show which settings would be close to dropouts in a session
+        HostLoadMonitor::Stats load;
+
+        double getRealTimeFactor() const { return audioSeconds / juce::jmax(1.0e-9, processingSeconds); }
+    };
+
+    OfflineRenderer();
+
+    // preset XML in the format savePreset() writes
+    bool loadPreset(const juce::File& presetFile);
+    void setState(const juce::ValueTree& state);
+
+    // memory maps the file when its format allows it (wav, aiff), otherwise a normal streaming reader
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& file);
+
+    Result render(const juce::File& inputFile, const juce::File& outputFile, const Settings& settings);
+
+    // the reader can be anything, e.g. a memory mapped one; the output format follows the
+    // output file's extension (wav, flac, aiff...)
+    Result render(juce::AudioFormatReader& reader, const juce::File& outputFile, const Settings& settings);
+
+    DistortionProjAudioProcessor& getProcessor() { return processor; }
+    juce::AudioFormatManager& getFormatManager() { return formats; }
+
+private:
+    DistortionProjAudioProcessor processor;
+    juce::AudioFormatManager formats;
+    juce::Random random {0x5e47};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
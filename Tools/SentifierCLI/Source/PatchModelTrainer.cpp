@@ -0,0 +1,582 @@
+/*
+  ==============================================================================
+
+    PatchModelTrainer.cpp
+    Created: 19 Oct 2026 6:03:27pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "PatchModelTrainer.h"
+#include "../../../Source/ImageAnalysisCache.h"
+#include "../../../Source/ImagePatchModel.h"
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace
+{
+    using Network = ImagePatchModel::Network;
+
+    const juce::StringArray imageExtensions {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp"};
+
+    // share of the dataset held back to pick the best epoch
+    constexpr double validationShare = 0.1;
+
+    struct Sample
+    {
+        juce::File image, preset;
+        ImagePatch patch;
+        ImageFeatures features;
+        bool ok {false};
+    };
+
+    bool readPatch(const juce::File& presetFile, ImagePatch& patch)
+    {
+        auto xml = juce::XmlDocument::parse(presetFile);
+        if(xml == nullptr)
+        {
+            return false;
+        }
+
+        auto state = juce::ValueTree::fromXml(*xml);
+
+        auto getValue = [&state](const juce::String& paramID, float& value)
+        {
+            auto param = state.getChildWithProperty("id", paramID);
+            if(!param.isValid() || !param.hasProperty("value"))
+                return false;
+
+            value = (float)param["value"];
+            return true;
+        };
+
+        float mode = 0;
+        bool ok = getValue("distortion mode", mode)
+               && getValue("drive", patch.drive)
+               && getValue("mix", patch.mix)
+               && getValue("lowCut Freq", patch.lowCutFreq)
+               && getValue("highCut Freq", patch.highCutFreq);
+
+        patch.distortionMode = juce::roundToInt(mode);
+        return ok;
+    }
+
+    // every preset with an image of the same name next to it. That's either the image's full name
+    // plus .xml, as --images writes them, or the same name with the image's extension swapped out
+    std::vector<Sample> findSamples(const juce::File& datasetFolder)
+    {
+        std::vector<Sample> samples;
+
+        for(const auto& entry : juce::RangedDirectoryIterator(datasetFolder, true, "*.xml", juce::File::findFiles))
+        {
+            const auto preset = entry.getFile();
+
+            const auto fullName = preset.getSiblingFile(preset.getFileNameWithoutExtension());
+            if(fullName.existsAsFile() && imageExtensions.contains(fullName.getFileExtension(), true))
+            {
+                Sample sample;
+                sample.image = fullName;
+                sample.preset = preset;
+                samples.push_back(sample);
+                continue;
+            }
+
+            for(const auto& extension : imageExtensions)
+            {
+                auto image = preset.withFileExtension(extension);
+                if(!image.existsAsFile())
+                    image = preset.withFileExtension(extension.toUpperCase());
+
+                if(image.existsAsFile())
+                {
+                    Sample sample;
+                    sample.image = image;
+                    sample.preset = preset;
+                    samples.push_back(sample);
+                    break;
+                }
+            }
+        }
+
+        return samples;
+    }
+
+    class FeatureJob : public juce::ThreadPoolJob
+    {
+    public:
+        FeatureJob(Sample& sampleToFill, ImageAnalysisCache* sharedCache)
+        : juce::ThreadPoolJob(sampleToFill.image.getFileName()),
+          sample(sampleToFill),
+          cache(sharedCache)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            if(!readPatch(sample.preset, sample.patch))
+            {
+                return jobHasFinished;
+            }
+
+            if(cache != nullptr)
+            {
+                sample.features = cache->getOrAnalyse(sample.image, analyser).features;
+            }
+            else
+            {
+                sample.features = analyser.extractFeatures(sample.image.getFullPathName().toStdString());
+            }
+
+            sample.ok = sample.features.hsv.analysedWidth > 0;
+            return jobHasFinished;
+        }
+
+    private:
+        Sample& sample;
+        ImageAnalysisCache* cache;
+        ImageAnalyser analyser;
+    };
+
+    // Mini-batch Adam over the same 3 layer network the plugin runs. Examples are columns, so each
+    // layer's forward and backward pass is a single matrix-matrix product. The four continuous
+    // outputs are trained with squared error in logit space, the mode scores with softmax
+    // cross-entropy.
+    class Trainer
+    {
+    public:
+        explicit Trainer(unsigned int seed)
+        {
+            const int sizes[] { Network::numInputs, ImagePatchModel::hidden1Size, ImagePatchModel::hidden2Size, Network::numOutputs };
+
+            std::mt19937 rng(seed);
+
+            for(size_t i = 0; i < layers.size(); ++i)
+            {
+                auto& layer = layers[i];
+                const int inputs = sizes[i], outputs = sizes[i + 1];
+
+                // Glorot uniform
+                const float limit = std::sqrt(6.f / (float)(inputs + outputs));
+                std::uniform_real_distribution<float> dist(-limit, limit);
+
+                layer.w = Matrix::NullaryExpr(outputs, inputs, [&]() { return dist(rng); });
+                layer.b = ColVector::Zero(outputs);
+                layer.mw = layer.vw = Matrix::Zero(outputs, inputs);
+                layer.mb = layer.vb = ColVector::Zero(outputs);
+            }
+        }
+
+        void getWeights(Network& network) const
+        {
+            network.w1 = layers[0].w; network.b1 = layers[0].b;
+            network.w2 = layers[1].w; network.b2 = layers[1].b;
+            network.w3 = layers[2].w; network.b3 = layers[2].b;
+        }
+
+        // the optimiser state as well as the weights, so a resumed run takes the same steps it
+        // would have taken without stopping
+        void writeState(juce::OutputStream& out) const
+        {
+            out.writeInt(step);
+
+            for(const auto& layer : layers)
+                for(const auto* parameter : { &layer.w, &layer.mw, &layer.vw })
+                    out.write(parameter->data(), (size_t)parameter->size() * sizeof(float));
+
+            for(const auto& layer : layers)
+                for(const auto* parameter : { &layer.b, &layer.mb, &layer.vb })
+                    out.write(parameter->data(), (size_t)parameter->size() * sizeof(float));
+        }
+
+        bool readState(juce::InputStream& in)
+        {
+            step = in.readInt();
+
+            auto readInto = [&in](auto& parameter)
+            {
+                const auto bytes = (int)(parameter.size() * (Eigen::Index)sizeof(float));
+                return in.read(parameter.data(), bytes) == bytes;
+            };
+
+            for(auto& layer : layers)
+                if(!readInto(layer.w) || !readInto(layer.mw) || !readInto(layer.vw))
+                    return false;
+
+            for(auto& layer : layers)
+                if(!readInto(layer.b) || !readInto(layer.mb) || !readInto(layer.vb))
+                    return false;
+
+            return step >= 0 && in.isExhausted();
+        }
+
+        // one Adam step, returns the summed loss over the batch
+        double trainBatch(const Matrix& inputs, const Matrix& targets, float learningRate)
+        {
+            forward(inputs);
+
+            int correct = 0;
+            const double loss = outputGradient(targets, correct);
+
+            // back through the layers, reusing the activations from forward()
+            for(int i = (int)layers.size() - 1; i >= 0; --i)
+            {
+                auto& layer = layers[(size_t)i];
+                const Matrix& layerInput = i == 0 ? inputs : activations[(size_t)i - 1];
+
+                gradW.noalias() = delta * layerInput.transpose();
+                gradB = delta.rowwise().sum();
+
+                if(i > 0)
+                {
+                    const auto& a = activations[(size_t)i - 1];
+                    Matrix previous = layer.w.transpose() * delta;
+                    delta = previous.array() * (1.f - a.array().square());
+                }
+
+                adam(layer.w, layer.mw, layer.vw, gradW, learningRate);
+                adam(layer.b, layer.mb, layer.vb, gradB, learningRate);
+            }
+
+            ++step;
+            return loss;
+        }
+
+        double evaluate(const Matrix& inputs, const Matrix& targets, int& correct)
+        {
+            forward(inputs);
+            return outputGradient(targets, correct);
+        }
+
+    private:
+        struct Layer
+        {
+            Matrix w, mw, vw;
+            ColVector b, mb, vb;
+        };
+
+        static constexpr float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1.0e-8f;
+
+        void forward(const Matrix& inputs)
+        {
+            for(size_t i = 0; i < layers.size(); ++i)
+            {
+                const Matrix& layerInput = i == 0 ? inputs : activations[i - 1];
+
+                activations[i].noalias() = layers[i].w * layerInput;
+                activations[i].colwise() += layers[i].b;
+
+                if(i != layers.size() - 1)
+                    activations[i] = activations[i].array().tanh().matrix();
+            }
+        }
+
+        // fills delta with dLoss/dOutput (averaged over the batch) and returns the summed loss
+        double outputGradient(const Matrix& targets, int& correct)
+        {
+            const auto& outputs = activations.back();
+            const auto batch = outputs.cols();
+            const auto numModes = ImagePatchModel::numModes;
+            const auto firstMode = ImagePatchModel::numContinuousOutputs;
+
+            delta.resize(outputs.rows(), batch);
+            double loss = 0;
+
+            for(Eigen::Index j = 0; j < batch; ++j)
+            {
+                auto out = outputs.col(j);
+                auto target = targets.col(j);
+
+                const auto error = (out.head(firstMode) - target.head(firstMode)).eval();
+                loss += 0.5 * error.squaredNorm();
+                delta.col(j).head(firstMode) = error;
+
+                Eigen::Index predicted = 0, expected = 0;
+                out.tail(numModes).maxCoeff(&predicted);
+                target.tail(numModes).maxCoeff(&expected);
+
+                const auto scores = (out.tail(numModes).array() - out.tail(numModes).maxCoeff()).exp().eval();
+                const auto probabilities = (scores / scores.sum()).eval();
+
+                loss -= std::log(std::max(probabilities[expected], 1.0e-12f));
+                delta.col(j).tail(numModes) = probabilities.matrix() - target.tail(numModes);
+
+                if(predicted == expected)
+                    ++correct;
+            }
+
+            delta /= (float)batch;
+            return loss;
+        }
+
+        template<typename Parameter>
+        void adam(Parameter& p, Parameter& m, Parameter& v, const Parameter& gradient, float learningRate)
+        {
+            m = beta1 * m + (1.f - beta1) * gradient;
+            v = beta2 * v + (1.f - beta2) * gradient.cwiseAbs2();
+
+            const float t = (float)(step + 1);
+            const float correction = learningRate * std::sqrt(1.f - std::pow(beta2, t)) / (1.f - std::pow(beta1, t));
+
+            p.array() -= correction * m.array() / (v.array().sqrt() + epsilon);
+        }
+
+        std::array<Layer, 3> layers;
+        std::array<Matrix, 3> activations;
+        Matrix delta, gradW;
+        ColVector gradB;
+        int step = 0;
+    };
+
+    // copies the chosen samples into one column each
+    void gatherColumns(const Matrix& source, const std::vector<int>& order, size_t start, size_t count, Matrix& dest)
+    {
+        dest.resize(source.rows(), (Eigen::Index)count);
+        for(size_t i = 0; i < count; ++i)
+            dest.col((Eigen::Index)i) = source.col(order[start + i]);
+    }
+
+    bool writeWeights(const Trainer& trainer, const juce::File& file)
+    {
+        Network network;
+        trainer.getWeights(network);
+
+        const auto data = network.saveWeights();
+        return file.replaceWithData(data.data(), data.size());
+    }
+
+    // everything --resume needs to carry on where a run stopped: how far it got, the best
+    // validation loss so far, the shuffling RNG and the trainer's weights and Adam moments
+    struct Checkpoint
+    {
+        static constexpr int version = 1;
+
+        int epoch = 0;
+        int bestEpoch = 0;
+        double bestLoss = std::numeric_limits<double>::max();
+    };
+
+    bool writeCheckpoint(const Checkpoint& checkpoint, const std::mt19937& rng, const Trainer& trainer, const juce::File& file)
+    {
+        juce::MemoryOutputStream out;
+        out.write("SNTC", 4);
+        out.writeInt(Checkpoint::version);
+        out.writeInt(checkpoint.epoch);
+        out.writeInt(checkpoint.bestEpoch);
+        out.writeDouble(checkpoint.bestLoss);
+
+        std::ostringstream rngState;
+        rngState << rng;
+        out.writeString(rngState.str());
+
+        trainer.writeState(out);
+        return file.replaceWithData(out.getData(), out.getDataSize());
+    }
+
+    bool readCheckpoint(const juce::File& file, Checkpoint& checkpoint, std::mt19937& rng, Trainer& trainer)
+    {
+        juce::MemoryBlock data;
+        if(!file.loadFileAsData(data) || data.getSize() < 8 || std::memcmp(data.getData(), "SNTC", 4) != 0)
+            return false;
+
+        juce::MemoryInputStream in(data, false);
+        in.skipNextBytes(4);
+
+        if(in.readInt() != Checkpoint::version)
+            return false;
+
+        checkpoint.epoch = in.readInt();
+        checkpoint.bestEpoch = in.readInt();
+        checkpoint.bestLoss = in.readDouble();
+
+        std::istringstream rngState(in.readString().toStdString());
+        rngState >> rng;
+
+        return !rngState.fail() && checkpoint.epoch >= 0 && trainer.readState(in);
+    }
+}
+
+void PatchModelTrainer::run(const juce::ArgumentList& args)
+{
+    auto datasetFolder = args.getExistingFolderForOption("--train");
+
+    auto outOption = args.getValueForOption("--out");
+    if(outOption.isEmpty())
+    {
+        juce::ConsoleApplication::fail("Expected --out <weights.bin>");
+    }
+    auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile(outOption.unquoted());
+
+    auto getIntOption = [&args](const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    const auto epochs = juce::jmax(1, getIntOption("--epochs", 200));
+    const auto batchSize = juce::jmax(1, getIntOption("--batch", 256));
+    const auto numThreads = juce::jmax(1, getIntOption("--threads", juce::SystemStats::getNumCpus()));
+    const auto learningRate = args.containsOption("--rate") ? args.getValueForOption("--rate").getFloatValue() : 0.001f;
+
+    juce::File checkpointFolder;
+    if(args.containsOption("--checkpoints"))
+    {
+        checkpointFolder = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--checkpoints").unquoted());
+        if(!checkpointFolder.createDirectory().wasOk())
+        {
+            juce::ConsoleApplication::fail("Couldn't create " + checkpointFolder.getFullPathName());
+        }
+    }
+
+    auto samples = findSamples(datasetFolder);
+    if(samples.empty())
+    {
+        juce::ConsoleApplication::fail("No (image, preset) pairs found in " + datasetFolder.getFullPathName());
+    }
+
+    std::cout << "Extracting features from " << samples.size() << " images..." << std::endl;
+
+    // one image per core, the same as the --images tool
+    cv::setNumThreads(1);
+
+    std::unique_ptr<juce::SharedResourcePointer<ImageAnalysisCache>> sharedCache;
+    ImageAnalysisCache* cache = nullptr;
+    if(args.containsOption("--cache"))
+    {
+        sharedCache = std::make_unique<juce::SharedResourcePointer<ImageAnalysisCache>>();
+        cache = &sharedCache->get();
+    }
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(numThreads);
+
+        for(auto& sample : samples)
+            pool.addJob(new FeatureJob(sample, cache), true);
+
+        while(pool.getNumJobs() > 0)
+        {
+            juce::Thread::sleep(50);
+        }
+    }
+
+    std::cout << "Features took " << (juce::Time::getMillisecondCounterHiRes() - start) * 0.001 << " s" << std::endl;
+
+    std::vector<const Sample*> usable;
+    for(const auto& sample : samples)
+    {
+        if(sample.ok)
+            usable.push_back(&sample);
+        else
+            std::cout << "Skipping: " << sample.preset.getFullPathName() << std::endl;
+    }
+
+    if(usable.size() < 2)
+    {
+        juce::ConsoleApplication::fail("Not enough usable samples to train on");
+    }
+
+    // the whole dataset as two matrices, one column per sample
+    const auto numSamples = (Eigen::Index)usable.size();
+    Matrix inputs(Network::numInputs, numSamples), targets(Network::numOutputs, numSamples);
+
+    std::array<float, ImageFeatures::vectorSize> values;
+    Network::OutputVector target;
+
+    for(Eigen::Index i = 0; i < numSamples; ++i)
+    {
+        usable[(size_t)i]->features.toArray(values);
+        inputs.col(i) = Eigen::Map<const Network::InputVector>(values.data());
+
+        ImagePatchModel::patchToTargets(usable[(size_t)i]->patch, target);
+        targets.col(i) = target;
+    }
+
+#ifdef EIGEN_HAS_OPENMP
+    Eigen::setNbThreads(numThreads);
+#endif
+
+    // fixed seed so the same dataset always gives the same split and the same model
+    std::mt19937 rng(0x5e47);
+
+    std::vector<int> order((size_t)numSamples);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    const auto numValidation = juce::jlimit<size_t>(1, order.size() - 1, (size_t)(order.size() * validationShare));
+    std::vector<int> validation(order.end() - (long)numValidation, order.end());
+    std::vector<int> training(order.begin(), order.end() - (long)numValidation);
+
+    Trainer trainer(rng());
+    Checkpoint progress;
+
+    // the split above only depends on the dataset, so a resumed run validates on the same samples
+    if(args.containsOption("--resume"))
+    {
+        auto resumeFile = args.getExistingFileForOption("--resume");
+
+        if(!readCheckpoint(resumeFile, progress, rng, trainer))
+        {
+            juce::ConsoleApplication::fail(resumeFile.getFullPathName() + " isn't a training checkpoint for this build");
+        }
+
+        std::cout << "Resuming after epoch " << progress.epoch << std::endl;
+    }
+
+    Matrix validationInputs, validationTargets, batchInputs, batchTargets;
+    gatherColumns(inputs, validation, 0, validation.size(), validationInputs);
+    gatherColumns(targets, validation, 0, validation.size(), validationTargets);
+
+    std::cout << "Training on " << training.size() << " samples, validating on " << validation.size() << std::endl;
+
+    start = juce::Time::getMillisecondCounterHiRes();
+
+    for(int epoch = progress.epoch + 1; epoch <= epochs; ++epoch)
+    {
+        std::shuffle(training.begin(), training.end(), rng);
+
+        double trainingLoss = 0;
+        for(size_t first = 0; first < training.size(); first += (size_t)batchSize)
+        {
+            const auto count = juce::jmin((size_t)batchSize, training.size() - first);
+            gatherColumns(inputs, training, first, count, batchInputs);
+            gatherColumns(targets, training, first, count, batchTargets);
+
+            trainingLoss += trainer.trainBatch(batchInputs, batchTargets, learningRate);
+        }
+
+        int correct = 0;
+        const auto validationLoss = trainer.evaluate(validationInputs, validationTargets, correct) / (double)validation.size();
+
+        progress.epoch = epoch;
+
+        if(validationLoss < progress.bestLoss)
+        {
+            progress.bestLoss = validationLoss;
+            progress.bestEpoch = epoch;
+
+            if(!writeWeights(trainer, outFile))
+            {
+                juce::ConsoleApplication::fail("Couldn't write " + outFile.getFullPathName());
+            }
+        }
+
+        if(checkpointFolder.exists())
+        {
+            const auto name = "epoch_" + juce::String(epoch).paddedLeft('0', 4);
+            writeWeights(trainer, checkpointFolder.getChildFile(name + ".bin"));
+            writeCheckpoint(progress, rng, trainer, checkpointFolder.getChildFile(name + ".ckpt"));
+        }
+
+        std::cout << "Epoch " << epoch
+                  << "  train loss " << trainingLoss / (double)training.size()
+                  << "  validation loss " << validationLoss
+                  << "  mode accuracy " << 100.0 * correct / (double)validation.size() << "%" << std::endl;
+    }
+
+    std::cout << std::endl
+              << "Training took " << (juce::Time::getMillisecondCounterHiRes() - start) * 0.001 << " s" << std::endl
+              << "Best epoch:   " << progress.bestEpoch << " (validation loss " << progress.bestLoss << ")" << std::endl
+              << "Weights in:   " << outFile.getFullPathName() << std::endl;
+}
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    PatchModelTrainer.h
+    Created: 19 Oct 2026 6:03:27pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Trains the image-to-patch model from a folder of (image, preset XML) pairs and exports
+// weights ImagePatchModel can load (add the file to the plugin's binary data as
+// imagePatchModel.bin to bundle it).
+namespace PatchModelTrainer
+{
+    // --train <datasetFolder> --out <weights.bin> [--epochs <n>] [--batch <n>] [--rate <r>]
+    //         [--threads <n>] [--checkpoints <folder>] [--resume <weights.bin>] [--cache]
+    void run(const juce::ArgumentList& args);
+}
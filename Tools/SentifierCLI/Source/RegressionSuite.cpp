@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    RegressionSuite.cpp
+    Created: 20 Oct 2026 2:37:05pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "RegressionSuite.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/RealtimeSafety.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    const float drives[] { 0.f, 10.f, 20.f };
+    const float mixes[] { 50.f, 100.f };
+
+    struct TestSignal
+    {
+        juce::String name;
+        juce::AudioBuffer<float> audio;
+    };
+
+    // the right channel is always different from the left so crossed or dropped channels show up
+    std::vector<TestSignal> createSignals()
+    {
+        std::vector<TestSignal> signals;
+
+        {
+            // one second log sweep, 20Hz to 20kHz
+            juce::AudioBuffer<float> sweep(2, (int)sampleRate);
+            const auto numSamples = sweep.getNumSamples();
+            const auto k = std::log(20000.0 / 20.0);
+            double phase = 0;
+
+            for(int i = 0; i < numSamples; ++i)
+            {
+                const auto frequency = 20.0 * std::exp(k * i / numSamples);
+                phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                sweep.setSample(0, i, 0.5f * (float)std::sin(phase));
+                sweep.setSample(1, i, 0.25f * (float)std::cos(phase));
+            }
+
+            signals.push_back({ "sweep", std::move(sweep) });
+        }
+
+        {
+            juce::AudioBuffer<float> noise(2, (int)sampleRate / 2);
+            juce::Random random(0x5e47);
+
+            for(int ch = 0; ch < 2; ++ch)
+                for(int i = 0; i < noise.getNumSamples(); ++i)
+                    noise.setSample(ch, i, 0.5f * (random.nextFloat() * 2.f - 1.f));
+
+            signals.push_back({ "noise", std::move(noise) });
+        }
+
+        {
+            // an impulse every 1/8 second, long enough apart for the filters to ring out
+            juce::AudioBuffer<float> impulses(2, (int)sampleRate / 2);
+            impulses.clear();
+
+            for(int i = 0; i < impulses.getNumSamples(); i += (int)sampleRate / 8)
+            {
+                impulses.setSample(0, i, 1.f);
+                impulses.setSample(1, i + 1, -0.5f);
+            }
+
+            signals.push_back({ "impulses", std::move(impulses) });
+        }
+
+        return signals;
+    }
+
+    void setParameter(DistortionProjAudioProcessor& processor, const juce::String& paramID, float value)
+    {
+        auto* param = processor.apvts.getParameter(paramID);
+        jassert(param != nullptr);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    // a fresh processor every time, so no case depends on the ones run before it
+    juce::AudioBuffer<float> render(const TestSignal& signal, int mode, float drive, float mix)
+    {
+        DistortionProjAudioProcessor processor;
+        if(mode == ChainSettings::neuralAmpMode)
+            setParameter(processor, "neural amp", 1.f);
+        else
+            setParameter(processor, "distortion mode", (float)mode);
+        setParameter(processor, "drive", drive);
+        setParameter(processor, "mix", mix);
+
+        processor.setNonRealtime(true);
+        processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> output(signal.audio);
+        juce::MidiBuffer midi;
+
+        for(int start = 0; start < output.getNumSamples(); start += blockSize)
+        {
+            const auto numSamples = juce::jmin(blockSize, output.getNumSamples() - start);
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), output.getNumChannels(), start, numSamples);
+            processor.processBlock(block, midi);
+        }
+
+        processor.releaseResources();
+        return output;
+    }
+
+    struct Comparison
+    {
+        int mismatches {0};
+        int firstMismatch {-1};
+        float peakError {0};
+    };
+
+    Comparison compare(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference)
+    {
+        Comparison result;
+
+        for(int ch = 0; ch < output.getNumChannels(); ++ch)
+        {
+            const auto* out = output.getReadPointer(ch);
+            const auto* ref = reference.getReadPointer(ch);
+
+            for(int i = 0; i < output.getNumSamples(); ++i)
+            {
+                // compares the bits so NaNs and signed zeros count too
+                if(std::memcmp(out + i, ref + i, sizeof(float)) != 0)
+                {
+                    ++result.mismatches;
+                    if(result.firstMismatch < 0 || i < result.firstMismatch)
+                        result.firstMismatch = i;
+
+                    const auto error = std::abs(out[i] - ref[i]);
+                    result.peakError = std::isnan(error) ? std::numeric_limits<float>::infinity()
+                                                         : juce::jmax(result.peakError, error);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // 32 bit float wav, so the references store exactly what the processor produced
+    bool writeReference(juce::AudioFormatManager& formats, const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if(stream == nullptr)
+            return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(formats.findFormatForFileExtension("wav")
+                                                            ->createWriterFor(stream.get(), sampleRate, (unsigned int)audio.getNumChannels(), 32, {}, 0));
+        if(writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    }
+
+    // Tools/SentifierCLI/regression, rendered from the processor as it was before the DSP
+    // optimisation work by make_references.sh in the same folder
+    juce::File getDefaultReferenceFolder()
+    {
+        return juce::File(__FILE__).getParentDirectory().getSiblingFile("regression");
+    }
+
+    bool readReference(juce::AudioFormatManager& formats, const juce::File& file, juce::AudioBuffer<float>& audio)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if(reader == nullptr || !reader->usesFloatingPointData || reader->numChannels != 2)
+            return false;
+
+        audio.setSize(2, (int)reader->lengthInSamples);
+        return reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+    }
+}
+
+void RegressionSuite::run(const juce::ArgumentList& args)
+{
+    auto referenceOption = args.getValueForOption("--regress");
+    auto referenceFolder = referenceOption.isEmpty() ? getDefaultReferenceFolder()
+                                                     : juce::File::getCurrentWorkingDirectory().getChildFile(referenceOption.unquoted());
+
+    const auto update = args.containsOption("--update");
+
+    // without --tolerance every sample has to match bit for bit
+    const auto bitExact = !args.containsOption("--tolerance");
+    const auto toleranceDb = bitExact ? -300.f : args.getValueForOption("--tolerance").getFloatValue();
+    const auto tolerance = juce::Decibels::decibelsToGain(toleranceDb, -300.f);
+
+    if(update && !referenceFolder.createDirectory().wasOk())
+    {
+        juce::ConsoleApplication::fail("Couldn't create " + referenceFolder.getFullPathName());
+    }
+    else if(!update && referenceFolder.getNumberOfChildFiles(juce::File::findFiles, "*.wav") == 0)
+    {
+        juce::ConsoleApplication::fail("No references in " + referenceFolder.getFullPathName()
+                                       + ", run make_references.sh in Tools/SentifierCLI/regression to render them from the "
+                                       + "original processor. Until then none of the DSP rewrites have been checked against it");
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    juce::StringArray modeNames;
+    {
+        DistortionProjAudioProcessor processor;
+        if(auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(processor.apvts.getParameter("distortion mode")))
+            modeNames = modeParam->choices;
+    }
+    modeNames.add("Neural Amp");
+
+    const auto signals = createSignals();
+    RealtimeSafety::clearViolations();
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    int numCases = 0, failures = 0;
+
+    for(int mode = 0; mode < modeNames.size(); ++mode)
+    {
+        for(const auto& signal : signals)
+        {
+            for(auto drive : drives)
+            {
+                for(auto mix : mixes)
+                {
+                    ++numCases;
+
+                    const auto name = juce::File::createLegalFileName(modeNames[mode].replaceCharacter(' ', '-').toLowerCase()
+                                                                      + "_" + signal.name
+                                                                      + "_drive" + juce::String((int)drive)
+                                                                      + "_mix" + juce::String((int)mix));
+                    auto file = referenceFolder.getChildFile(name + ".wav");
+                    auto output = render(signal, mode, drive, mix);
+
+                    if(update)
+                    {
+                        if(!writeReference(formats, file, output))
+                        {
+                            ++failures;
+                            std::cout << "Couldn't write " << file.getFullPathName() << std::endl;
+                        }
+                        continue;
+                    }
+
+                    juce::AudioBuffer<float> reference;
+                    if(!readReference(formats, file, reference))
+                    {
+                        ++failures;
+                        std::cout << "FAIL " << name << ": no usable reference" << std::endl;
+                        continue;
+                    }
+
+                    if(reference.getNumSamples() != output.getNumSamples())
+                    {
+                        ++failures;
+                        std::cout << "FAIL " << name << ": " << output.getNumSamples() << " samples, reference has "
+                                  << reference.getNumSamples() << std::endl;
+                        continue;
+                    }
+
+                    const auto result = compare(output, reference);
+                    const auto passed = bitExact ? result.mismatches == 0 : result.peakError <= tolerance;
+
+                    if(!passed)
+                    {
+                        ++failures;
+                        std::cout << "FAIL " << name << ": " << result.mismatches << " samples differ, first at "
+                                  << result.firstMismatch << ", peak error "
+                                  << juce::Decibels::gainToDecibels(result.peakError, -300.f) << " dBFS" << std::endl;
+                    }
+                    else if(result.mismatches > 0)
+                    {
+                        std::cout << "ok   " << name << ": within tolerance, peak error "
+                                  << juce::Decibels::gainToDecibels(result.peakError, -300.f) << " dBFS" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    // in builds with the real-time checks on, anything processBlock() allocated or locked
+    // fails the run too
+    const auto violations = RealtimeSafety::getViolations();
+    for(const auto& violation : violations)
+    {
+        ++failures;
+        std::cout << std::endl << "FAIL " << violation.what << " inside processBlock(), " << violation.count
+                  << " times, from:" << std::endl << violation.stackTrace << std::endl;
+    }
+
+    std::cout << std::endl
+              << (update ? "Wrote " : "Checked ") << numCases << " cases in " << elapsed << " s";
+    if(RealtimeSafety::isEnabled())
+        std::cout << ", real-time checks on";
+    if(!update)
+        std::cout << (bitExact ? ", bit exact" : ", tolerance " + juce::String(toleranceDb) + " dBFS").toStdString();
+    std::cout << std::endl;
+
+    if(failures > 0)
+    {
+        juce::ConsoleApplication::fail(juce::String(failures) + " of " + juce::String(numCases) + " cases failed", 1);
+    }
+}
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    RegressionSuite.h
+    Created: 20 Oct 2026 2:37:05pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Golden output checks for the processor. Fixed test signals (a sine sweep, noise and impulses)
+// go through every distortion mode at a few drive and mix settings and are compared against
+// reference renders, so DSP rewrites can be checked for identical output before they go in.
+namespace RegressionSuite
+{
+    // --regress [referenceFolder] [--update] [--tolerance <dBFS>], the folder defaults to the
+    // committed references in Tools/SentifierCLI/regression
+    void run(const juce::ArgumentList& args);
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    RenderTool.cpp
+    Created: 20 Oct 2026 9:14:36am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "RenderTool.h"
+#include "OfflineRenderer.h"
+
+void RenderTool::run(const juce::ArgumentList& args)
+{
+    auto inputFile = args.getExistingFileForOption("--render");
+
+    auto outOption = args.getValueForOption("--out");
+    if(outOption.isEmpty())
+    {
+        juce::ConsoleApplication::fail("Expected --out <out.wav>");
+    }
+    auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile(outOption.unquoted());
+
+    auto getIntOption = [&args](const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    OfflineRenderer::Settings settings;
+    settings.blockSize = juce::jlimit(1, 65536, getIntOption("--block", settings.blockSize));
+    settings.varyBlockSize = args.containsOption("--vary-blocks");
+    settings.bitsPerSample = juce::jmax(0, getIntOption("--bits", 0));
+
+    OfflineRenderer renderer;
+
+    if(args.containsOption("--preset"))
+    {
+        auto presetFile = args.getExistingFileForOption("--preset");
+        if(!renderer.loadPreset(presetFile))
+        {
+            juce::ConsoleApplication::fail("Couldn't load preset " + presetFile.getFullPathName());
+        }
+    }
+
+    const auto result = renderer.render(inputFile, outFile, settings);
+    if(!result.ok)
+    {
+        juce::ConsoleApplication::fail(result.error);
+    }
+
+    std::cout << "Rendered " << result.numSamples << " samples (" << result.audioSeconds << "s) to "
+              << outFile.getFullPathName() << std::endl
+              << "Processing " << result.processingSeconds << "s, wall " << result.wallSeconds << "s, "
+              << result.getRealTimeFactor() << "x real time" << std::endl
+              << "Block load:  " << HostLoadMonitor::toString(result.load) << std::endl;
+}
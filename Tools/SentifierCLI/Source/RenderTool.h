@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    RenderTool.h
+    Created: 20 Oct 2026 9:14:36am
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Renders an audio file through the plugin without a host, for checking presets and timing the
+// processor on real material.
+namespace RenderTool
+{
+    // --render <in.wav> --out <out.wav|flac> [--preset <preset.xml>] [--block <n>] [--vary-blocks] [--bits <n>]
+    void run(const juce::ArgumentList& args);
+}
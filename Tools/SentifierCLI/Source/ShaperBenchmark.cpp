@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    ShaperBenchmark.cpp
+    Created: 19 Oct 2026 8:26:51pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#include "ShaperBenchmark.h"
+#include "../../../Source/NeuralShaper.h"
+
+void ShaperBenchmark::run(const juce::ArgumentList& args)
+{
+    auto getOption = [&args](const juce::String& option, double defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getDoubleValue() : defaultValue;
+    };
+
+    const auto seconds = juce::jmax(1.0, getOption("--seconds", 20.0));
+    const auto blockSize = juce::jmax(1, (int)getOption("--block", 512));
+    const auto sampleRate = juce::jmax(8000.0, getOption("--rate", 48000.0));
+
+    NeuralShaper shaper;
+    shaper.prepare({ sampleRate, (juce::uint32)blockSize, 1 });
+    shaper.setParameter(NeuralShaper::ParameterId::kPreamp, 12.f);
+    shaper.setParameter(NeuralShaper::ParameterId::kMix, 100.f);
+
+    // a fresh block of noise every time so nothing settles into a denormal or constant state
+    juce::Random random(0x5e47);
+    juce::AudioBuffer<float> source(1, blockSize * 16), buffer(1, blockSize);
+    for(int i = 0; i < source.getNumSamples(); ++i)
+        source.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+
+    const auto numBlocks = (int)std::ceil(seconds * sampleRate / blockSize);
+    const auto numSourceBlocks = source.getNumSamples() / blockSize;
+
+    juce::ScopedNoDenormals noDenormals;
+    double processingSeconds = 0, worstBlock = 0;
+
+    for(int n = 0; n < numBlocks; ++n)
+    {
+        buffer.copyFrom(0, 0, source, 0, (n % numSourceBlocks) * blockSize, blockSize);
+
+        auto block = juce::dsp::AudioBlock<float>(buffer);
+        auto context = juce::dsp::ProcessContextReplacing<float>(block);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        shaper.process(context);
+        const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        processingSeconds += elapsed;
+        worstBlock = juce::jmax(worstBlock, elapsed);
+    }
+
+    const auto audioSeconds = (double)numBlocks * blockSize / sampleRate;
+    const auto coreShare = processingSeconds / audioSeconds;
+
+    std::cout << "Neural amp, 1 x " << NeuralShaper::hiddenSize << " GRU, one channel at " << sampleRate << " Hz" << std::endl
+              << "Per sample:    " << processingSeconds / ((double)numBlocks * blockSize) * 1.0e9 << " ns" << std::endl
+              << "Real time:     " << audioSeconds / processingSeconds << "x" << std::endl
+              << "Core share:    " << coreShare * 100.0 << "% (budget " << NeuralShaper::cpuBudgetPerChannel * 100.0 << "%)" << std::endl
+              << "Worst block:   " << worstBlock * 1000.0 << " ms of " << blockSize / sampleRate * 1000.0 << " ms" << std::endl;
+
+    if(coreShare > NeuralShaper::cpuBudgetPerChannel)
+    {
+        juce::ConsoleApplication::fail("Over the per-channel CPU budget", 1);
+    }
+}
@@ -0,0 +1,20 @@
+/*
+  ==============================================================================
+
+    ShaperBenchmark.h
+    Created: 19 Oct 2026 8:26:51pm
+    Author:  Max Ellis
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Times the neural amp mode on its own and checks it against NeuralShaper::cpuBudgetPerChannel
+namespace ShaperBenchmark
+{
+    // --bench-shaper [--seconds <n>] [--block <n>] [--rate <hz>]
+    void run(const juce::ArgumentList& args);
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Renders the --regress reference files into this folder from the processor as it was before the
+# DSP optimisation work (the commit that added the regression suite), so later rewrites are
+# checked against the original output rather than against themselves.
+#
+#   Tools/SentifierCLI/regression/make_references.sh [commit]
+#
+# Needs Xcode, and Projucer on the PATH or in PROJUCER. Commit the .wav files it writes.
+#
+# No references have been rendered or committed yet, so --regress has never been run against the
+# original output. Every DSP change since the suite was added is unverified until they are,
+# including the per-order oversampling modules, the bypass crossfade restructure around
+# processChain() and the BiquadCascade cut filters and emphasis EQ.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+repo=$(git -C "$here" rev-parse --show-toplevel)
+commit=${1:-$(git -C "$repo" log --format=%h -1 --diff-filter=A -- Tools/SentifierCLI/Source/RegressionSuite.cpp)}
+projucer=${PROJUCER:-Projucer}
+
+tree=$(mktemp -d)/sentifier-reference
+git -C "$repo" worktree add --detach "$tree" "$commit"
+trap 'git -C "$repo" worktree remove --force "$tree"' EXIT
+
+"$projucer" --resave "$tree/Tools/SentifierCLI/SentifierCLI.jucer"
+xcodebuild -project "$tree/Tools/SentifierCLI/Builds/MacOSX/SentifierCLI.xcodeproj" -configuration Release -quiet
+
+rm -f "$here"/*.wav
+"$tree/Tools/SentifierCLI/Builds/MacOSX/build/Release/SentifierCLI" --regress="$here" --update